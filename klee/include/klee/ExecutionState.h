@@ -12,6 +12,7 @@
 
 #include "klee/Constraints.h"
 #include "klee/Expr.h"
+#include "klee/Internal/ADT/CopyOnWrite.h"
 #include "klee/Internal/ADT/TreeStream.h"
 
 // FIXME: We do not want to be exposing these? :(
@@ -40,7 +41,9 @@ struct StackFrame {
   CallPathNode *callPathNode;
 
   std::vector<const MemoryObject*> allocas;
-  Cell *locals;
+  /// The registers, shared with the frame this one was copied from
+  /// until either writes to them.
+  CopyOnWrite< std::vector<Cell> > locals;
 
   /// Minimum distance to an uncovered instruction once the function
   /// returns. This is not a good place for this but is used to
@@ -49,6 +52,10 @@ struct StackFrame {
   /// periodically.
   unsigned minDistToUncoveredOnReturn;
 
+  /// Like minDistToUncoveredOnReturn, counting only the uncovered
+  /// instructions of focused functions.
+  unsigned minDistToFocusedOnReturn;
+
   // For vararg functions: arguments not passed via parameter are
   // stored (packed tightly) in a local (alloca) memory object. This
   // is setup to match the way the front-end generates vaarg code (it
@@ -61,6 +68,48 @@ struct StackFrame {
   ~StackFrame();
 };
 
+/// The symbolic objects of a state in creation order, used to generate
+/// test cases. The list holds a reference to each of its MemoryObjects,
+/// so that states can share it.
+class SymbolicList {
+public:
+  typedef std::pair<const MemoryObject*, const Array*> value_type;
+
+private:
+  std::vector<value_type> elements;
+
+  // DO NOT IMPLEMENT.
+  SymbolicList &operator=(const SymbolicList&);
+
+public:
+  SymbolicList() {}
+  SymbolicList(const SymbolicList &b);
+  ~SymbolicList();
+
+  unsigned size() const { return elements.size(); }
+  const value_type &operator[](unsigned i) const { return elements[i]; }
+  void push_back(const value_type &v);
+
+  bool operator==(const SymbolicList &b) const { 
+    return elements == b.elements; 
+  }
+};
+
+/// A sparse set of instruction ids (see InstructionInfo::id), stored as
+/// the non-zero 64-bit words of the bitset in increasing index order.
+class InstructionBitSet {
+public:
+  typedef std::vector< std::pair<unsigned, uint64_t> > words_ty;
+
+private:
+  words_ty words;
+
+public:
+  void insert(unsigned id);
+  bool empty() const { return words.empty(); }
+  const words_ty &getWords() const { return words; }
+};
+
 class ExecutionState {
 public:
   typedef std::vector<StackFrame> stack_ty;
@@ -68,7 +117,7 @@ public:
 private:
   // unsupported, use copy constructor
   ExecutionState &operator=(const ExecutionState&); 
-  std::map< std::string, std::string > fnAliases;
+  CopyOnWrite< std::map< std::string, std::string > > fnAliases;
 
 public:
   // id of the state, increment by fork, addbyxqx201409
@@ -94,21 +143,34 @@ public:
   AddressSpace addressSpace;
   TreeOStream pathOS, symPathOS;
   unsigned instsSinceCovNew;
+  /// Number of instructions executed along this path, used to find the
+  /// point at which a reloaded spilled state was spilled.
+  uint64_t steppedInstructions;
   bool coveredNew;
 
   /// Disables forking, set by user code.
   bool forkDisabled;
 
-  std::map<const std::string*, std::set<unsigned> > coveredLines;
+  /// Branch condition of a speculatively forked state which has not
+  /// been checked for feasibility yet (null once resolved). The
+  /// condition is not part of \ref constraints until it is resolved.
+  ref<Expr> speculativeCondition;
+
+  /// Instructions covered for the first time by this state. Like the
+  /// other copy-on-write members, this is shared with the states it was
+  /// forked from or into until one of them changes it.
+  CopyOnWrite<InstructionBitSet> coveredInstructions;
   PTreeNode *ptreeNode;
 
   /// ordered list of symbolics: used to generate test cases. 
-  //
-  // FIXME: Move to a shared list structure (not critical).
-  std::vector< std::pair<const MemoryObject*, const Array*> > symbolics;
+  CopyOnWrite<SymbolicList> symbolics;
 
   /// Set of used array names.  Used to avoid collisions.
-  std::set<std::string> arrayNames;
+  CopyOnWrite< std::set<std::string> > arrayNames;
+
+  /// Symbolic checksum comparisons taken to hold, as (computed, stored)
+  /// pairs. The stored values are fixed up when a test is generated.
+  std::vector< std::pair< ref<Expr>, ref<Expr> > > checksumChecks;
 
   // Used by the checkpoint/rollback methods for fake objects.
   // FIXME: not freeing things on branch deletion.
@@ -144,7 +206,11 @@ public:
     constraints.addConstraint(e); 
   }
 
-  bool merge(const ExecutionState &b);
+  /// Merge \a b into this state. Fails if the states are not at the
+  /// same point with the same stack, or if merging would create more
+  /// than \a maxCost select expressions (one per differing register
+  /// and per byte of a differing object).
+  bool merge(const ExecutionState &b, unsigned maxCost = ~0u);
   void dumpStack(std::ostream &out) const;
 };
 
@@ -577,16 +577,35 @@ private:
   unsigned computeHash();
 };
 
+/// ArrayContents - The immutable initial bytes of a constant array,
+/// reference counted so that arrays (and their users) can share them
+/// without copying.
+class ArrayContents {
+public:
+  unsigned refCount;
+
+private:
+  const std::vector<uint8_t> bytes;
+
+public:
+  ArrayContents(const uint8_t *begin, const uint8_t *end)
+    : refCount(0), bytes(begin, end) {}
+
+  unsigned size() const { return bytes.size(); }
+  uint8_t operator[](unsigned index) const { return bytes[index]; }
+  const uint8_t *data() const { return bytes.empty() ? 0 : &bytes[0]; }
+};
+
 class Array {
 public:
   const std::string name;
   // FIXME: Not 64-bit clean.
   unsigned size;  
 
-  /// constantValues - The constant initial values for this array, or empty for
-  /// a symbolic array. If non-empty, this size of this array is equivalent to
-  /// the array size.
-  const std::vector< ref<ConstantExpr> > constantValues;
+  /// contents - The constant initial values for this array, or null for a
+  /// symbolic array. If non-null, the number of bytes is equal to the
+  /// array size.
+  const ref<ArrayContents> contents;
   
 public:
   /// Array - Construct a new array object.
@@ -598,26 +617,35 @@ public:
   /// distinguished once printed.
   Array(const std::string &_name, uint64_t _size, 
         const ref<ConstantExpr> *constantValuesBegin = 0,
-        const ref<ConstantExpr> *constantValuesEnd = 0)
-    : name(_name), size(_size), 
-      constantValues(constantValuesBegin, constantValuesEnd) {      
-    assert((isSymbolicArray() || constantValues.size() == size) &&
-           "Invalid size for constant array!");
+        const ref<ConstantExpr> *constantValuesEnd = 0);
+
+  /// Array - Construct a new constant array object over existing contents.
+  Array(const std::string &_name, uint64_t _size,
+        const ref<ArrayContents> &_contents)
+    : name(_name), size(_size), contents(_contents) {
+    assert(contents->size() == size && "Invalid size for constant array!");
     computeHash();
-#ifndef NDEBUG
-    for (const ref<ConstantExpr> *it = constantValuesBegin;
-         it != constantValuesEnd; ++it)
-      assert((*it)->getWidth() == getRange() &&
-             "Invalid initial constant value!");
-#endif
   }
   ~Array();
 
-  bool isSymbolicArray() const { return constantValues.empty(); }
+  bool isSymbolicArray() const { return contents.isNull(); }
   bool isConstantArray() const { return !isSymbolicArray(); }
 
   Expr::Width getDomain() const { return Expr::Int32; }
   Expr::Width getRange() const { return Expr::Int8; }
+
+  /// getConstantValue - Return the initial byte at the given index of a
+  /// constant array.
+  uint8_t getConstantValue(unsigned index) const {
+    assert(isConstantArray() && index < size && "Invalid constant read!");
+    return (*contents)[index];
+  }
+
+  /// getConstantExpr - Return the initial byte at the given index of a
+  /// constant array as an expression.
+  ref<ConstantExpr> getConstantExpr(unsigned index) const {
+    return ConstantExpr::alloc(getConstantValue(index), getRange());
+  }
   
   unsigned computeHash();
   unsigned hash() const { return hashValue; }
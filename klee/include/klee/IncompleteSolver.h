@@ -97,6 +97,10 @@ public:
   bool computeTruth(const Query&, bool &isValid);
   bool computeValidity(const Query&, Solver::Validity &result);
   bool computeValue(const Query&, ref<Expr> &result);
+  bool computeFeasibility(const ConstraintManager &constraints,
+                          const std::vector< ref<Expr> > &exprs,
+                          std::vector<bool> &results);
+  bool computeRange(const Query&, uint64_t &min, uint64_t &max);
   bool computeInitialValues(const Query&,
                             const std::vector<const Array*> &objects,
                             std::vector< std::vector<unsigned char> > &values,
@@ -0,0 +1,71 @@
+//===-- CopyOnWrite.h -------------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef KLEE_COPYONWRITE_H
+#define KLEE_COPYONWRITE_H
+
+namespace klee {
+  /// CopyOnWrite - A value which is shared between copies of its
+  /// holder until one of them asks to modify it.
+  ///
+  /// Copying and assignment only adjust a reference count; the value
+  /// itself is copied by getWriteable() when it is still shared. T must
+  /// be copy constructible and default constructible.
+  template<class T>
+  class CopyOnWrite {
+    struct Node {
+      unsigned refCount;
+      T value;
+
+      Node() : refCount(1) {}
+      explicit Node(const T &_value) : refCount(1), value(_value) {}
+    };
+
+    Node *node;
+
+    void release() {
+      if (--node->refCount == 0)
+        delete node;
+    }
+
+  public:
+    CopyOnWrite() : node(new Node()) {}
+    explicit CopyOnWrite(const T &value) : node(new Node(value)) {}
+    CopyOnWrite(const CopyOnWrite &b) : node(b.node) { ++node->refCount; }
+    ~CopyOnWrite() { release(); }
+
+    CopyOnWrite &operator=(const CopyOnWrite &b) {
+      ++b.node->refCount;
+      release();
+      node = b.node;
+      return *this;
+    }
+
+    const T &operator*() const { return node->value; }
+    const T *operator->() const { return &node->value; }
+
+    /// getWriteable - Return the value for modification, first making
+    /// a private copy of it if it is shared.
+    T &getWriteable() {
+      if (node->refCount > 1) {
+        Node *copy = new Node(node->value);
+        --node->refCount;
+        node = copy;
+      }
+      return node->value;
+    }
+
+    bool operator==(const CopyOnWrite &b) const {
+      return node == b.node || node->value == b.node->value;
+    }
+    bool operator!=(const CopyOnWrite &b) const { return !(*this == b); }
+  };
+}
+
+#endif
@@ -13,6 +13,7 @@
 #include <map>
 #include <string>
 #include <set>
+#include <vector>
 
 namespace llvm {
   class Function;
@@ -51,6 +52,8 @@ namespace klee {
     std::string dummyString;
     InstructionInfo dummyInfo;
     std::map<const llvm::Instruction*, InstructionInfo> infos;
+    /// The entries of infos, indexed by id.
+    std::vector<const InstructionInfo*> infosByID;
     std::set<const std::string *, ltstr> internedStrings;
 
   private:
@@ -65,6 +68,7 @@ namespace klee {
     unsigned getMaxID() const;
     const InstructionInfo &getInfo(const llvm::Instruction*) const;
     const InstructionInfo &getFunctionInfo(const llvm::Function*) const;
+    const InstructionInfo &getInfoByID(unsigned id) const;
   };
 
 }
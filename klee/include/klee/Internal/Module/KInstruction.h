@@ -38,6 +38,16 @@ namespace klee {
     /// Destination register index.
     unsigned dest;
 
+    /// The opcode of inst, cached so that dispatch does not have to
+    /// touch the LLVM instruction.
+    unsigned opcode;
+    /// Bit width of the result, or 0 if the result type is unsized.
+    unsigned width;
+    /// For terminators, the index into KFunction::instructions of the
+    /// first instruction of each successor, in successor order;
+    /// otherwise null.
+    unsigned *successors;
+
   public:
     virtual ~KInstruction(); 
   };
@@ -0,0 +1,99 @@
+//===-- Driver.h ------------------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Driver code shared by the klee and xklee tools: reading concolic file
+// specs, seed distillation and running a list of functions in worker
+// processes.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef KLEE_DRIVER_H
+#define KLEE_DRIVER_H
+
+#include "klee/Interpreter.h"
+
+#include <string>
+#include <vector>
+
+struct KTest;
+
+namespace llvm {
+  class Function;
+}
+
+namespace klee {
+  /// Read the concolic files given by a --sym-conf-file. Each line lists
+  /// comma separated "offset-length" ranges, optionally followed by
+  /// ":method" to override \a method for that range. The ranges belong
+  /// to \a path, or to the path after a line "@path".
+  bool readSymConfigFile(const std::string &confFile, const std::string &path,
+                         unsigned method,
+                         std::vector<Interpreter::ConcolicFile> &files);
+
+  /// Merge the bytes of each concolic file which reached branches in
+  /// focused functions into ranges, and write them, the most branched-on
+  /// first, to sym-ranges.conf in the --sym-conf-file format.
+  void writeInferredSymRanges(Interpreter *interpreter,
+                              InterpreterHandler *handler,
+                              const std::vector<Interpreter::ConcolicFile> &files);
+
+  /// Replay each seed concretely, recording the basic blocks it enters,
+  /// and keep a subset of the seeds covering the same blocks, picked
+  /// greedily by the blocks each adds.  The \a extra other seeds
+  /// covering the most blocks are kept after them, the rest are freed.
+  /// The choice is written to distilled-seeds.txt.  The handler should
+  /// not write test cases meanwhile.  If \a interrupted gets set, the
+  /// seeds are left as they are.
+  void distillSeeds(Interpreter *interpreter, InterpreterHandler *handler,
+                    llvm::Function *mainFn, int argc, char **argv,
+                    char **envp, std::vector<KTest *> &seeds,
+                    const std::vector<std::string> &seedFiles,
+                    unsigned extra, const bool &interrupted);
+
+  /// Merge the run.istats written by the --run-func-list workers into
+  /// \a output.
+  bool mergeRunIStats(const std::vector<std::string> &inputs,
+                      const std::string &output);
+
+  /// Copy the test cases of a worker's output directory into the
+  /// handler's, renumbering them after the \a testIndex tests already
+  /// collected.  Returns the number of tests copied.
+  unsigned collectTestCases(InterpreterHandler *handler,
+                            const std::string &dir, unsigned &testIndex);
+
+  struct FunctionListOptions {
+    /// The file listing the functions, one per line.
+    std::string listFile;
+    /// The program; the arguments after it are the program's own.
+    std::string inputFile;
+    /// The number of workers to run at once, 0 for one per processor.
+    unsigned jobs;
+    /// Seconds each worker may run, 0 to use maxTime.
+    double funcTime;
+    double maxTime;
+    bool watchdog;
+
+    FunctionListOptions()
+      : jobs(0), funcTime(0), maxTime(0), watchdog(false) {}
+  };
+
+  /// Run each function of the list with --run-func in its own worker
+  /// process \a program, passing on \a arguments but for the worker's
+  /// own options.  Each worker gets an output directory func-<name>
+  /// inside the handler's; their test cases and run.istats are then
+  /// collected in the handler's output directory.  No new workers are
+  /// started once \a interrupted is set.  Returns the number of tests
+  /// collected.
+  unsigned runFunctionList(InterpreterHandler *handler, const char *program,
+                           const std::vector<std::string> &arguments,
+                           const FunctionListOptions &opts,
+                           const bool &interrupted);
+}
+
+#endif
@@ -81,6 +81,25 @@ public:
 	  SMTLIB2 //.SMT2 files (SMTLIB version 2 files)
   };
 
+  /// ConcolicRange - A byte range of a concolic input file which is
+  /// made symbolic, and how the file around it is filled (one of the
+  /// fill_* methods of the POSIX runtime).
+  struct ConcolicRange {
+    unsigned offset;
+    unsigned length;
+    unsigned fillMethod;
+
+    ConcolicRange(unsigned _offset, unsigned _length, unsigned _fillMethod)
+      : offset(_offset), length(_length), fillMethod(_fillMethod) {}
+  };
+
+  /// ConcolicFile - A concrete input file, opened by path, whose
+  /// listed ranges are made symbolic.
+  struct ConcolicFile {
+    std::string path;
+    std::vector<ConcolicRange> ranges;
+  };
+
   /// InterpreterOptions - Options varying the runtime behavior during
   /// interpretation.
   struct InterpreterOptions {
@@ -89,8 +108,14 @@ public:
     /// symbolic execution on concrete programs.
     unsigned MakeConcreteSymbolic;
 
+    /// Follow the path seeded by the contents of the concolic files, and
+    /// record which of their bytes reach branch conditions in focused
+    /// functions. \see Interpreter::getBranchInputBytes()
+    bool InferSymRanges;
+
     InterpreterOptions()
-      : MakeConcreteSymbolic(false)
+      : MakeConcreteSymbolic(false),
+        InferSymRanges(false)
     {}
   };
 
@@ -132,10 +157,20 @@ public:
   // a user specified path. use null to reset.
   virtual void setReplayPath(const std::vector<bool> *path) = 0;
 
+  // supply a bitmap, indexed by the id of the first instruction of each
+  // basic block, in which the blocks entered are set. while recording,
+  // the coverage statistics are not updated. use null to stop
+  // recording.
+  virtual void setBlockCoverage(std::vector<bool> *blocks) = 0;
+
   // supply a set of symbolic bindings that will be used as "seeds"
   // for the search. use null to reset.
   virtual void useSeeds(const std::vector<struct KTest *> *seeds) = 0;
 
+  // supply the concrete input files whose ranges the POSIX runtime
+  // makes symbolic when they are opened.
+  virtual void setConcolicFiles(const std::vector<ConcolicFile> &files) = 0;
+
   virtual void runFunctionAsMain(llvm::Function *f,
                                  int argc,
                                  char **argv,
@@ -166,6 +201,12 @@ public:
   virtual void getCoveredLines(const ExecutionState &state,
                                std::map<const std::string*, std::set<unsigned> > &res) = 0;
 
+  // with InterpreterOptions::InferSymRanges, the number of branch
+  // conditions in focused functions each byte of each symbolic object
+  // (by name) has reached.
+  virtual void getBranchInputBytes(
+      std::map<std::string, std::map<unsigned, unsigned> > &res) = 0;
+
   virtual void printStatsInfoWithSrcLine() = 0;
   virtual void xRunFunction(llvm::Function *f) =0;
 
@@ -156,6 +156,22 @@ namespace klee {
     /// \return True on success.
     bool mayBeFalse(const Query&, bool &result);
 
+    /// mayBeTrue - Determine for each of the given expressions whether
+    /// there is a valid assignment for the constraints in which it
+    /// evaluates to true.
+    ///
+    /// This is equivalent to calling mayBeTrue once per expression,
+    /// but lets the underlying solver share the constraint set between
+    /// the queries (e.g. the cases of a symbolic switch).
+    ///
+    /// \param [out] results - On success, results[i] is true iff
+    /// exprs[i] may be true.
+    ///
+    /// \return True on success.
+    bool mayBeTrue(const ConstraintManager &constraints,
+                   const std::vector< ref<Expr> > &exprs,
+                   std::vector<bool> &results);
+
     /// getValue - Compute one possible value for the given expression.
     ///
     /// \param [out] result - On success, a value for the expression in some
@@ -194,6 +210,14 @@ namespace klee {
     //
     // FIXME: This should go into a helper class, and should handle failure.
     virtual std::pair< ref<Expr>, ref<Expr> > getRange(const Query&);
+
+    /// getRange - Compute the range of the query expression in a single
+    /// solver context, as getRange(const Query&) does when the solver
+    /// supports it.
+    ///
+    /// \return True on success; false if the solver failed or cannot
+    /// compute ranges this way.
+    bool getRange(const Query&, uint64_t &min, uint64_t &max);
     
     virtual char *getConstraintLog(const Query& query);
     virtual void setCoreSolverTimeout(double timeout);
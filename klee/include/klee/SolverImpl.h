@@ -14,6 +14,7 @@
 
 namespace klee {
   class Array;
+  class ConstraintManager;
   class ExecutionState;
   class Expr;
   struct Query;
@@ -83,6 +84,44 @@ namespace klee {
     /// \return True on success
     virtual bool computeValue(const Query& query, ref<Expr> &result) = 0;
     
+    /// computeFeasibility - Determine for each of a list of expressions
+    /// whether it may be true given a common set of constraints.
+    ///
+    /// The expressions are guaranteed to be non-constant and have bool
+    /// type.
+    ///
+    /// SolverImpl provides a default implementation which issues one
+    /// computeTruth query per expression. Clients should override this
+    /// if the expressions can share work on the constraint set.
+    ///
+    /// \param [out] results - On success, results[i] is true iff
+    /// \f[ \exists X constraints(X) \land exprs_i(X) \f]
+    ///
+    /// \return True on success
+    virtual bool computeFeasibility(const ConstraintManager &constraints,
+                                    const std::vector< ref<Expr> > &exprs,
+                                    std::vector<bool> &results);
+
+    /// computeRange - Compute the tight unsigned range of the query
+    /// expression given the constraints.
+    ///
+    /// The query expression is guaranteed to be non-constant, non-bool
+    /// and at most 64 bits wide.
+    ///
+    /// SolverImpl provides a default implementation which returns
+    /// false, in which case Solver::getRange falls back to a sequence
+    /// of independent queries. Clients should override this if they
+    /// can answer the whole range within one solver context.
+    ///
+    /// \param [out] min - On success, the least feasible value.
+    /// \param [out] max - On success, the greatest feasible value.
+    ///
+    /// \return True on success
+    virtual bool computeRange(const Query& query, uint64_t &min,
+                              uint64_t &max) {
+      return false;
+    }
+
     /// \sa Solver::getInitialValues()
     virtual bool computeInitialValues(const Query& query,
                                       const std::vector<const Array*> 
@@ -106,6 +106,12 @@ extern "C" {
   void klee_prefer_cex(void *object, uintptr_t condition);
   void klee_mark_global(void *object);
 
+  /* Compare a computed checksum with the stored one. Returns 1 if they
+     match; a symbolic comparison always matches, and the stored value
+     is fixed up in the generated test. Calls are inserted by
+     --bypass-checksums. */
+  int klee_checksum_match(uint64_t computed, uint64_t expected);
+
   /* Return a possible constant value for the input expression. This
      allows programs to forcibly concretize values on their own. */
 #define KLEE_GET_VALUE_PROTO(suffix, type)	type klee_get_value##suffix(type expr)
@@ -131,6 +137,21 @@ extern "C" {
   /* Enable/disable forking. */
   void klee_set_forking(unsigned enable);
 
+  /* Look up path in the concolic input files given to KLEE. Returns the
+     index of the file, or -1 if it is not a concolic file; a null path
+     returns the number of concolic files. The total number of ranges of
+     the file is stored in *n_ranges and up to max_ranges of them are
+     copied to ranges, each as three unsigned ints (offset, length and
+     fill method). */
+  int klee_get_concolic_file(const char *path, void *ranges,
+                             unsigned max_ranges, unsigned *n_ranges);
+
+  /* Copy up to count bytes at offset of a file of size bytes held in
+     contents to dest, preserving symbolic bytes, and return the number
+     of bytes copied. This is read(2) for the POSIX runtime's files. */
+  size_t klee_read_file_bytes(void *dest, const char *contents, size_t size,
+                              long long offset, size_t count);
+
   /* klee_alias_function("foo", "bar") will replace, at runtime (on
      the current path and all paths spawned on the current path), all
      calls to foo() by calls to bar().  foo() and bar() have to exist
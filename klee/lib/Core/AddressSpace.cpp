@@ -15,7 +15,10 @@
 #include "klee/Expr.h"
 #include "klee/TimerStatIncrementer.h"
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <set>
 #include <sstream>
 
 #if LLVM_VERSION_CODE >= LLVM_VERSION(3, 3)
@@ -29,11 +32,20 @@
 #include "klee/Internal/Module/KInstruction.h"
 #include "klee/Internal/Module/InstructionInfoTable.h"
 
+#include "llvm/Support/CommandLine.h"
+
 using namespace klee;
 using namespace llvm;
 
 #define XQX_DEBUG
 
+namespace {
+	cl::opt<unsigned>
+		MaxResolveCandidates("max-resolve-candidates",
+				cl::desc("Maximum number of objects in the range of a symbolic pointer to check in one batched query before falling back to a search (default=256, 0=never batch)"),
+				cl::init(256));
+}
+
 ///
 
 void AddressSpace::bindObject(const MemoryObject *mo, ObjectState *os) {
@@ -193,6 +205,229 @@ bool AddressSpace::resolveOne(ExecutionState &state,
 	}
 }
 
+/// Bound the unsigned value of e from its structure alone, without
+/// asking the solver: a constant base plus a scaled, masked or extended
+/// index, as address arithmetic usually is. The interval may be wider
+/// than the real range, but never narrower.
+static void getInterval(ref<Expr> e, uint64_t &min, uint64_t &max) {
+	Expr::Width width = e->getWidth();
+	uint64_t mask = width >= 64 ? ~(uint64_t) 0 : ((uint64_t) 1 << width) - 1;
+	min = 0;
+	max = mask;
+	if (width > 64)
+		return;
+
+	uint64_t lmin, lmax, rmin, rmax;
+	switch (e->getKind()) {
+	case Expr::Constant:
+		min = max = cast<ConstantExpr>(e)->getZExtValue();
+		return;
+
+	case Expr::ZExt:
+		getInterval(e->getKid(0), min, max);
+		return;
+
+	case Expr::SExt:
+		getInterval(e->getKid(0), lmin, lmax);
+		// Non-negative values are extended as they are.
+		if (lmax < ((uint64_t) 1 << (e->getKid(0)->getWidth() - 1))) {
+			min = lmin;
+			max = lmax;
+		}
+		return;
+
+	case Expr::Select:
+		getInterval(e->getKid(1), lmin, lmax);
+		getInterval(e->getKid(2), rmin, rmax);
+		min = std::min(lmin, rmin);
+		max = std::max(lmax, rmax);
+		return;
+
+	case Expr::Add:
+		getInterval(e->getKid(0), lmin, lmax);
+		getInterval(e->getKid(1), rmin, rmax);
+		if (lmax <= mask - rmax) {
+			min = lmin + rmin;
+			max = lmax + rmax;
+		}
+		return;
+
+	case Expr::Mul:
+	case Expr::Shl: {
+		ConstantExpr *CE = dyn_cast<ConstantExpr>(e->getKid(1));
+		ref<Expr> other = e->getKid(0);
+		if (!CE && e->getKind() == Expr::Mul) {
+			CE = dyn_cast<ConstantExpr>(e->getKid(0));
+			other = e->getKid(1);
+		}
+		if (!CE)
+			return;
+		uint64_t factor = CE->getZExtValue();
+		if (e->getKind() == Expr::Shl)
+			factor = factor < width ? (uint64_t) 1 << factor : 0;
+		getInterval(other, lmin, lmax);
+		if (factor && lmax <= mask / factor) {
+			min = lmin * factor;
+			max = lmax * factor;
+		}
+		return;
+	}
+
+	case Expr::LShr:
+		if (ConstantExpr *CE = dyn_cast<ConstantExpr>(e->getKid(1))) {
+			uint64_t shift = CE->getZExtValue();
+			if (shift >= width)
+				return;
+			getInterval(e->getKid(0), lmin, lmax);
+			min = lmin >> shift;
+			max = lmax >> shift;
+		}
+		return;
+
+	case Expr::And:
+		getInterval(e->getKid(0), lmin, lmax);
+		getInterval(e->getKid(1), rmin, rmax);
+		max = std::min(lmax, rmax);
+		return;
+
+	default:
+		return;
+	}
+}
+
+bool AddressSpace::getObjectsInInterval(uint64_t min, uint64_t max,
+		std::vector<ObjectPair> &candidates) {
+	// The map is ordered by address and objects do not overlap, so the
+	// candidates are the object containing min (if any) and every object
+	// starting in (min, max].
+	MemoryObject hack(min);
+	MemoryMap::iterator oi = objects.upper_bound(&hack);
+	MemoryMap::iterator begin = objects.begin();
+	MemoryMap::iterator end = objects.end();
+	if (oi != begin)
+		--oi;
+
+	candidates.clear();
+	for (; oi != end && oi->first->address <= max; ++oi) {
+		const MemoryObject *mo = oi->first;
+		if (mo->address < min && min - mo->address >= std::max(mo->size, 1U))
+			continue;
+		if (candidates.size() == MaxResolveCandidates)
+			return false;
+		candidates.push_back(*oi);
+	}
+	return true;
+}
+
+bool AddressSpace::getBaseObjectInterval(ExecutionState &state,
+		TimingSolver *solver,
+		ref<Expr> p,
+		uint64_t &min, uint64_t &max) {
+	// Addresses are built as base + offset, with constants folded to the
+	// left.
+	if (p->getKind() != Expr::Add || !MaxResolveCandidates)
+		return false;
+	ConstantExpr *base = dyn_cast<ConstantExpr>(p->getKid(0));
+	if (!base || base->getWidth() > 64)
+		return false;
+
+	// Take as many objects around the base object as are checked in one
+	// batch.
+	MemoryObject hack(base->getZExtValue());
+	MemoryMap::iterator begin = objects.begin();
+	MemoryMap::iterator end = objects.end();
+	MemoryMap::iterator lo = objects.upper_bound(&hack);
+	if (lo == begin)
+		return false;
+	--lo;
+	MemoryMap::iterator hi = lo;
+	for (unsigned n = 1; n < MaxResolveCandidates;) {
+		MemoryMap::iterator next = hi;
+		++next;
+		if (lo == begin && next == end)
+			break;
+		if (lo != begin) {
+			--lo;
+			++n;
+		}
+		if (next != end && n < MaxResolveCandidates) {
+			hi = next;
+			++n;
+		}
+	}
+
+	uint64_t lower = lo->first->address;
+	uint64_t upper = hi->first->address + std::max(hi->first->size, 1U) - 1;
+	Expr::Width width = p->getWidth();
+	bool mustBeTrue;
+	if (!solver->mustBeTrue(state,
+				AndExpr::create(UgeExpr::create(p, ConstantExpr::create(lower, width)),
+					UleExpr::create(p, ConstantExpr::create(upper, width))),
+				mustBeTrue) || !mustBeTrue)
+		return false;
+
+	min = lower;
+	max = upper;
+	return true;
+}
+
+bool AddressSpace::resolveInRange(ExecutionState &state,
+		TimingSolver *solver,
+		ref<Expr> p,
+		ResolutionList &rl,
+		unsigned maxResolutions,
+		bool &incomplete,
+		uint64_t timeout_us,
+		TimerStatIncrementer &timer) {
+	uint64_t min, max;
+	getInterval(p, min, max);
+
+	std::vector<ObjectPair> candidates;
+	if (!getObjectsInInterval(min, max, candidates)) {
+		// The structure of the address bounds it too loosely, as for an
+		// index read from memory; narrow the bound by solving for it, or
+		// else by the objects around its base.
+		if (timeout_us && timeout_us < timer.check()) {
+			incomplete = true;
+			return true;
+		}
+		if (!(solver->getRange(state, p, min, max) &&
+					getObjectsInInterval(min, max, candidates)) &&
+				!(getBaseObjectInterval(state, solver, p, min, max) &&
+					getObjectsInInterval(min, max, candidates)))
+			return false;
+	}
+
+	std::vector< ref<Expr> > inBounds;
+	for (unsigned i = 0, e = candidates.size(); i != e; ++i)
+		inBounds.push_back(candidates[i].first->getBoundsCheckPointer(p));
+
+	if (timeout_us && timeout_us < timer.check()) {
+		incomplete = true;
+		return true;
+	}
+
+	std::vector<bool> mayBeTrue;
+	if (!solver->mayBeTrue(state, inBounds, mayBeTrue)) {
+		incomplete = true;
+		return true;
+	}
+
+	incomplete = false;
+	for (unsigned i = 0, e = candidates.size(); i != e; ++i) {
+		if (!mayBeTrue[i])
+			continue;
+		if (maxResolutions && rl.size() == maxResolutions) {
+			incomplete = true;
+			break;
+		}
+		rl.push_back(candidates[i]);
+	}
+
+	++stats::resolveRangeQueries;
+	return true;
+}
+
 bool AddressSpace::resolve(ExecutionState &state,
 		TimingSolver *solver, 
 		ref<Expr> p, 
@@ -229,6 +464,31 @@ bool AddressSpace::resolve(ExecutionState &state,
 		uint64_t example = cex->getZExtValue();
 		MemoryObject hack(example);
 
+		// Fast path: the pointer cannot leave the object the example
+		// points into.
+		if (const MemoryMap::value_type *res = objects.lookup_previous(&hack)) {
+			const MemoryObject *mo = res->first;
+			if (example - mo->address < mo->size) {
+				bool mustBeTrue;
+				if (!solver->mustBeTrue(state, mo->getBoundsCheckPointer(p),
+							mustBeTrue))
+					return true;
+				if (mustBeTrue) {
+					rl.push_back(*res);
+					return false;
+				}
+			}
+		}
+
+		// Otherwise bound the pointer and only ask about the objects in
+		// its range, all at once.
+		if (MaxResolveCandidates) {
+			bool incomplete;
+			if (resolveInRange(state, solver, p, rl, maxResolutions, incomplete,
+						timeout_us, timer))
+				return incomplete;
+		}
+
 		MemoryMap::iterator oi = objects.upper_bound(&hack);
 		MemoryMap::iterator begin = objects.begin();
 		MemoryMap::iterator end = objects.end();
@@ -324,7 +584,7 @@ bool AddressSpace::resolve(ExecutionState &state,
 // transparently avoid screwing up symbolics (if the byte is symbolic
 // then its concrete cache byte isn't being used) but is just a hack.
 
-void AddressSpace::copyOutConcretes() {
+void AddressSpace::copyOutConcretes(bool skipSynced) {
 	for (MemoryMap::iterator it = objects.begin(), ie = objects.end(); 
 			it != ie; ++it) {
 		const MemoryObject *mo = it->first;
@@ -333,10 +593,34 @@ void AddressSpace::copyOutConcretes() {
 			ObjectState *os = it->second;
 			uint8_t *address = (uint8_t*) (unsigned long) mo->address;
 
-			if (!os->readOnly)
+			// The host memory still holds these exact bytes if they were the
+			// last ones copied in either direction, unless an external
+			// wrote it without that being copied back in.
+			if (!os->readOnly &&
+					(!skipSynced || mo->hostStoreVersion != os->storeVersion)) {
 				memcpy(address, os->concreteStore, mo->size);
+				mo->hostStoreVersion = os->storeVersion;
+			}
+		}
+	}
+}
+
+bool AddressSpace::copyInConcrete(const MemoryObject *mo, 
+		const ObjectState *os) {
+	uint8_t *address = (uint8_t*) (unsigned long) mo->address;
+
+	if (memcmp(address, os->concreteStore, mo->size)!=0) {
+		if (os->readOnly) {
+			return false;
+		} else {
+			ObjectState *wos = getWriteable(mo, os);
+			memcpy(wos->concreteStore, address, mo->size);
+			wos->markStoreModified();
+			mo->hostStoreVersion = wos->storeVersion;
 		}
 	}
+
+	return true;
 }
 
 bool AddressSpace::copyInConcretes() {
@@ -345,17 +629,65 @@ bool AddressSpace::copyInConcretes() {
 		const MemoryObject *mo = it->first;
 
 		if (!mo->isUserSpecified) {
-			const ObjectState *os = it->second;
-			uint8_t *address = (uint8_t*) (unsigned long) mo->address;
+			if (!copyInConcrete(mo, it->second))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+bool AddressSpace::copyInConcretes(const std::vector<uint64_t> &addresses) {
+	for (std::vector<uint64_t>::const_iterator it = addresses.begin(),
+			ie = addresses.end(); it != ie; ++it) {
+		ObjectPair op;
+		if (!resolveOne(ConstantExpr::create(*it, Context::get().getPointerWidth()), 
+					op))
+			continue;
 
-			if (memcmp(address, os->concreteStore, mo->size)!=0) {
-				if (os->readOnly) {
+		if (!op.first->isUserSpecified) {
+			if (!copyInConcrete(op.first, op.second))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+bool AddressSpace::collectConcreteReachable(const std::vector<uint64_t> &roots,
+		unsigned maxObjects,
+		std::vector<uint64_t> &reached) {
+	unsigned pointerBytes = Context::get().getPointerWidth() / 8;
+	std::set<const MemoryObject*> visited;
+	std::vector<uint64_t> worklist(roots);
+
+	while (!worklist.empty()) {
+		uint64_t address = worklist.back();
+		worklist.pop_back();
+
+		ObjectPair op;
+		if (!resolveOne(ConstantExpr::create(address, Context::get().getPointerWidth()),
+					op))
+			continue;
+		const MemoryObject *mo = op.first;
+		const ObjectState *os = op.second;
+		if (!visited.insert(mo).second)
+			continue;
+		if (visited.size() > maxObjects)
+			return false;
+		reached.push_back(mo->address);
+
+		if (os->concreteMask)
+			for (unsigned i = 0; i < os->size; ++i)
+				if (!os->isByteConcrete(i))
 					return false;
-				} else {
-					ObjectState *wos = getWriteable(mo, os);
-					memcpy(wos->concreteStore, address, mo->size);
-				}
-			}
+
+		// Anything that looks like a pointer may be followed by the callee.
+		for (unsigned i = 0; i + pointerBytes <= os->size; i += pointerBytes) {
+			uint64_t value = 0;
+			memcpy(&value, os->concreteStore + i, pointerBytes);
+			if (value)
+				worklist.push_back(value);
 		}
 	}
 
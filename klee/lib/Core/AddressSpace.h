@@ -20,6 +20,7 @@ namespace klee {
   class ExecutionState;
   class MemoryObject;
   class ObjectState;
+  class TimerStatIncrementer;
   class TimingSolver;
 
   template<class T> class ref;
@@ -41,6 +42,44 @@ namespace klee {
 
     /// Unsupported, use copy constructor
     AddressSpace &operator=(const AddressSpace&); 
+
+    /// Copy the host memory of one object back into its ObjectState if
+    /// it changed; fails if the object is read-only.
+    bool copyInConcrete(const MemoryObject *mo, const ObjectState *os);
+
+    /// Collect the objects overlapping [min, max] into candidates.
+    /// \return false if there are more than --max-resolve-candidates.
+    bool getObjectsInInterval(uint64_t min, uint64_t max,
+                              std::vector<ObjectPair> &candidates);
+
+    /// Bound address by the --max-resolve-candidates objects around the
+    /// object its constant base points into, if the address cannot
+    /// leave them.
+    /// \return true iff the address was bounded.
+    bool getBaseObjectInterval(ExecutionState &state,
+                               TimingSolver *solver,
+                               ref<Expr> address,
+                               uint64_t &min, uint64_t &max);
+
+    /// Resolve address by bounding it and checking every object that
+    /// overlaps the bound in one batched query. The bound comes from the
+    /// structure of the expression; if that holds too many objects, from
+    /// a solver range query, and if the solver cannot answer, from the
+    /// address's base object.
+    ///
+    /// \param[out] incomplete Set as for resolve() when handled.
+    /// \param timeout_us The remaining budget of resolve(), checked
+    /// against timer before the query.
+    /// \return false if the bound holds too many objects, in which case
+    /// the caller should fall back to searching from an example.
+    bool resolveInRange(ExecutionState &state,
+                        TimingSolver *solver,
+                        ref<Expr> address,
+                        ResolutionList &rl,
+                        unsigned maxResolutions,
+                        bool &incomplete,
+                        uint64_t timeout_us,
+                        TimerStatIncrementer &timer);
     
   public:
     /// The MemoryObject -> ObjectState map that constitutes the
@@ -114,8 +153,11 @@ namespace klee {
     ObjectState *getWriteable(const MemoryObject *mo, const ObjectState *os);
 
     /// Copy the concrete values of all managed ObjectStates into the
-    /// actual system memory location they were allocated at.
-    void copyOutConcretes();
+    /// actual system memory location they were allocated at. With
+    /// \a skipSynced, objects whose bytes were the last ones copied in
+    /// either direction are skipped, which assumes every host write
+    /// since was copied back in.
+    void copyOutConcretes(bool skipSynced = false);
 
     /// Copy the concrete values of all managed ObjectStates back from
     /// the actual system memory location they were allocated
@@ -126,6 +168,21 @@ namespace klee {
     /// \retval true The copy succeeded. 
     /// \retval false The copy failed because a read-only object was modified.
     bool copyInConcretes();
+
+    /// Like copyInConcretes(), but only for the objects containing the
+    /// given addresses (e.g. the pointer arguments of an external call
+    /// known to write nothing else).
+    bool copyInConcretes(const std::vector<uint64_t> &addresses);
+
+    /// Collect the base addresses of the objects reachable from the
+    /// given addresses, following every pointer-aligned concrete value
+    /// that points into an object.
+    ///
+    /// \return false if a reachable object has a byte which is not
+    /// concrete, or more than \a maxObjects objects are reachable.
+    bool collectConcreteReachable(const std::vector<uint64_t> &roots,
+                                  unsigned maxObjects,
+                                  std::vector<uint64_t> &reached);
     void printFileLine(ExecutionState &state, KInstruction *ki);
   };
 } // End klee namespace
@@ -12,6 +12,7 @@
 using namespace klee;
 
 Statistic stats::allocations("Allocations", "Alloc");
+Statistic stats::autoMerges("AutoMerges", "AMerges");
 Statistic stats::coveredInstructions("CoveredInstructions", "Icov");
 Statistic stats::falseBranches("FalseBranches", "Bf");
 Statistic stats::forkTime("ForkTime", "Ftime");
@@ -19,11 +20,17 @@ Statistic stats::forks("Forks", "Forks");
 Statistic stats::instructionRealTime("InstructionRealTimes", "Ireal");
 Statistic stats::instructionTime("InstructionUserTimes", "IUsertime");
 Statistic stats::instructions("Instructions", "I");
+Statistic stats::minDistToFocusedUncovered("MinDistToFocusedUncovered", "FUCdist");
 Statistic stats::minDistToReturn("MinDistToReturn", "Rdist");
 Statistic stats::minDistToUncovered("MinDistToUncovered", "UCdist");
+Statistic stats::nativeCalls("NativeCalls", "NCalls");
+Statistic stats::prunedStates("PrunedStates", "Pruned");
 Statistic stats::reachableUncovered("ReachableUncovered", "IuncovReach");
+Statistic stats::resolveRangeQueries("ResolveRangeQueries", "RRQ");
 Statistic stats::resolveTime("ResolveTime", "Rtime");
 Statistic stats::solverTime("SolverTime", "Stime");
+Statistic stats::speculativeDiscards("SpeculativeDiscards", "SpecDisc");
+Statistic stats::speculativeForks("SpeculativeForks", "SpecForks");
 Statistic stats::states("States", "States");
 Statistic stats::trueBranches("TrueBranches", "Bt");
 Statistic stats::uncoveredInstructions("UncoveredInstructions", "Iuncov");
@@ -17,6 +17,10 @@ namespace stats {
 
   extern Statistic allocations;
   extern Statistic resolveTime;
+
+  /// The number of symbolic pointers resolved by checking the objects in
+  /// their range in one batched query.
+  extern Statistic resolveRangeQueries;
   extern Statistic instructions;
   extern Statistic instructionTime;
   extern Statistic instructionRealTime;
@@ -30,6 +34,24 @@ namespace stats {
   /// The number of process forks.
   extern Statistic forks;
 
+  /// The number of calls run natively through the JIT (see
+  /// --native-functions).
+  extern Statistic nativeCalls;
+
+  /// The number of forks whose non-seed side was created without a
+  /// feasibility query (see --speculative-fork), and how many of those
+  /// states were later found infeasible and discarded.
+  extern Statistic speculativeForks;
+  extern Statistic speculativeDiscards;
+
+  /// The number of states merged away at join points of focused
+  /// functions (see --use-auto-merge).
+  extern Statistic autoMerges;
+
+  /// The number of states terminated because they could no longer
+  /// reach uncovered focused code (see --prune-unreachable-states).
+  extern Statistic prunedStates;
+
   /// Number of states, this is a "fake" statistic used by istats, it
   /// isn't normally up-to-date.
   extern Statistic states;
@@ -43,6 +65,10 @@ namespace stats {
   /// updated.
   extern Statistic minDistToUncovered;
 
+  /// Instruction level statistic like minDistToUncovered, counting only
+  /// the uncovered instructions of focused functions.
+  extern Statistic minDistToFocusedUncovered;
+
   /// Instruction level statistic tracking the minimum intraprocedural
   /// distance to a function return.
   extern Statistic minDistToReturn;
@@ -25,6 +25,7 @@
 #endif
 #include "llvm/Support/CommandLine.h"
 
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <cassert>
@@ -46,8 +47,9 @@ namespace {
 
 StackFrame::StackFrame(KInstIterator _caller, KFunction *_kf)
   : caller(_caller), kf(_kf), callPathNode(0), 
-    minDistToUncoveredOnReturn(0), varargs(0) {
-  locals = new Cell[kf->numRegisters];
+    locals(std::vector<Cell>(_kf->numRegisters)),
+    minDistToUncoveredOnReturn(0), minDistToFocusedOnReturn(0),
+    varargs(0) {
 }
 
 StackFrame::StackFrame(const StackFrame &s) 
@@ -55,15 +57,56 @@ StackFrame::StackFrame(const StackFrame &s)
     kf(s.kf),
     callPathNode(s.callPathNode),
     allocas(s.allocas),
+    locals(s.locals),
     minDistToUncoveredOnReturn(s.minDistToUncoveredOnReturn),
+    minDistToFocusedOnReturn(s.minDistToFocusedOnReturn),
     varargs(s.varargs) {
-  locals = new Cell[s.kf->numRegisters];
-  for (unsigned i=0; i<s.kf->numRegisters; i++)
-    locals[i] = s.locals[i];
 }
 
 StackFrame::~StackFrame() { 
-  delete[] locals; 
+}
+
+/***/
+
+SymbolicList::SymbolicList(const SymbolicList &b) : elements(b.elements) {
+  for (unsigned i=0; i<elements.size(); i++)
+    elements[i].first->refCount++;
+}
+
+SymbolicList::~SymbolicList() {
+  for (unsigned i=0; i<elements.size(); i++) {
+    const MemoryObject *mo = elements[i].first;
+    assert(mo->refCount > 0);
+    mo->refCount--;
+    if (mo->refCount == 0)
+      delete mo;
+  }
+}
+
+void SymbolicList::push_back(const value_type &v) {
+  v.first->refCount++;
+  elements.push_back(v);
+}
+
+/***/
+
+namespace {
+  struct WordIndexLT {
+    bool operator()(const std::pair<unsigned, uint64_t> &a, unsigned b) const {
+      return a.first < b;
+    }
+  };
+}
+
+void InstructionBitSet::insert(unsigned id) {
+  unsigned index = id / 64;
+  uint64_t bit = (uint64_t) 1 << (id % 64);
+  words_ty::iterator it = std::lower_bound(words.begin(), words.end(), index,
+                                           WordIndexLT());
+  if (it != words.end() && it->first == index)
+    it->second |= bit;
+  else
+    words.insert(it, std::make_pair(index, bit));
 }
 
 /***/
@@ -77,6 +120,7 @@ ExecutionState::ExecutionState(KFunction *kf)
     queryCost(0.), 
     weight(1),
     instsSinceCovNew(0),
+    steppedInstructions(0),
     coveredNew(false),
     forkDisabled(false),
 	id(0),
@@ -98,15 +142,6 @@ ExecutionState::ExecutionState(const std::vector<ref<Expr> > &assumptions)
 }
 
 ExecutionState::~ExecutionState() {
-  for (unsigned int i=0; i<symbolics.size(); i++)
-  {
-    const MemoryObject *mo = symbolics[i].first;
-    assert(mo->refCount > 0);
-    mo->refCount--;
-    if (mo->refCount == 0)
-      delete mo;
-  }
-
   while (!stack.empty()) popFrame();
 }
 
@@ -125,12 +160,15 @@ ExecutionState::ExecutionState(const ExecutionState& state)
     pathOS(state.pathOS),
     symPathOS(state.symPathOS),
     instsSinceCovNew(state.instsSinceCovNew),
+    steppedInstructions(state.steppedInstructions),
     coveredNew(state.coveredNew),
     forkDisabled(state.forkDisabled),
-    coveredLines(state.coveredLines),
+    speculativeCondition(state.speculativeCondition),
+    coveredInstructions(state.coveredInstructions),
     ptreeNode(state.ptreeNode),
     symbolics(state.symbolics),
     arrayNames(state.arrayNames),
+    checksumChecks(state.checksumChecks),
     shadowObjects(state.shadowObjects),
 	id(state.id),
 	stateRange(state.stateRange),
@@ -138,8 +176,6 @@ ExecutionState::ExecutionState(const ExecutionState& state)
     prevStackLevel(state.prevStackLevel),
     incomingBBIndex(state.incomingBBIndex)
 {
-  for (unsigned int i=0; i<symbolics.size(); i++)
-    symbolics[i].first->refCount++;
 }
 
 ExecutionState *ExecutionState::branch(uint64_t sid) {
@@ -147,7 +183,7 @@ ExecutionState *ExecutionState::branch(uint64_t sid) {
 
   ExecutionState *falseState = new ExecutionState(*this);
   falseState->coveredNew = false;
-  falseState->coveredLines.clear();
+  falseState->coveredInstructions = CopyOnWrite<InstructionBitSet>();
 
   weight *= .5;
   falseState->weight -= weight;
@@ -173,24 +209,23 @@ void ExecutionState::popFrame() {
 }
 
 void ExecutionState::addSymbolic(const MemoryObject *mo, const Array *array) { 
-  mo->refCount++;
-  symbolics.push_back(std::make_pair(mo, array));
+  symbolics.getWriteable().push_back(std::make_pair(mo, array));
 }
 ///
 
 std::string ExecutionState::getFnAlias(std::string fn) {
-  std::map < std::string, std::string >::iterator it = fnAliases.find(fn);
-  if (it != fnAliases.end())
+  std::map < std::string, std::string >::const_iterator it = fnAliases->find(fn);
+  if (it != fnAliases->end())
     return it->second;
   else return "";
 }
 
 void ExecutionState::addFnAlias(std::string old_fn, std::string new_fn) {
-  fnAliases[old_fn] = new_fn;
+  fnAliases.getWriteable()[old_fn] = new_fn;
 }
 
 void ExecutionState::removeFnAlias(std::string fn) {
-  fnAliases.erase(fn);
+  fnAliases.getWriteable().erase(fn);
 }
 
 /**/
@@ -208,18 +243,26 @@ std::ostream &klee::operator<<(std::ostream &os, const MemoryMap &mm) {
   return os;
 }
 
-bool ExecutionState::merge(const ExecutionState &b) {
+bool ExecutionState::merge(const ExecutionState &b, unsigned maxCost) {
   if (DebugLogStateMerge)
     std::cerr << "-- attempting merge of A:" 
                << this << " with B:" << &b << "--\n";
   if (pc != b.pc)
     return false;
 
+  // An unresolved speculative branch condition is not in the
+  // constraints yet, so merging would drop or misapply it.
+  if (!speculativeCondition.isNull() || !b.speculativeCondition.isNull())
+    return false;
+
   // XXX is it even possible for these to differ? does it matter? probably
   // implies difference in object states?
   if (symbolics!=b.symbolics)
     return false;
 
+  if (checksumChecks!=b.checksumChecks)
+    return false;
+
   {
     std::vector<StackFrame>::const_iterator itA = stack.begin();
     std::vector<StackFrame>::const_iterator itB = b.stack.begin();
@@ -307,6 +350,30 @@ bool ExecutionState::merge(const ExecutionState &b) {
       std::cerr << "\t\tmappings differ\n";
     return false;
   }
+
+  if (maxCost != ~0u) {
+    unsigned cost = 0;
+    for (std::set<const MemoryObject*>::iterator it = mutated.begin(), 
+           ie = mutated.end(); it != ie; ++it)
+      cost += (*it)->size;
+    std::vector<StackFrame>::const_iterator itA = stack.begin();
+    std::vector<StackFrame>::const_iterator itB = b.stack.begin();
+    for (; itA!=stack.end() && cost<=maxCost; ++itA, ++itB) {
+      if (&*itA->locals == &*itB->locals)
+        continue;
+      for (unsigned i=0; i<itA->kf->numRegisters; i++) {
+        const ref<Expr> &av = (*itA->locals)[i].value;
+        const ref<Expr> &bv = (*itB->locals)[i].value;
+        if (!av.isNull() && !bv.isNull() && av != bv)
+          ++cost;
+      }
+    }
+    if (cost > maxCost) {
+      if (DebugLogStateMerge)
+        std::cerr << "\t\tmerge cost " << cost << " exceeds limit\n";
+      return false;
+    }
+  }
   
   // merge stack
 
@@ -328,9 +395,10 @@ bool ExecutionState::merge(const ExecutionState &b) {
   for (; itA!=stack.end(); ++itA, ++itB) {
     StackFrame &af = *itA;
     const StackFrame &bf = *itB;
+    std::vector<Cell> &aLocals = af.locals.getWriteable();
     for (unsigned i=0; i<af.kf->numRegisters; i++) {
-      ref<Expr> &av = af.locals[i].value;
-      const ref<Expr> &bv = bf.locals[i].value;
+      ref<Expr> &av = aLocals[i].value;
+      const ref<Expr> &bv = (*bf.locals)[i].value;
       if (av.isNull() || bv.isNull()) {
         // if one is null then by implication (we are at same pc)
         // we cannot reuse this local, so just ignore
@@ -386,7 +454,7 @@ void ExecutionState::dumpStack(std::ostream &out) const {
 
       out << ai->getName().str();
       // XXX should go through function
-      ref<Expr> value = sf.locals[sf.kf->getArgRegister(index++)].value; 
+      ref<Expr> value = (*sf.locals)[sf.kf->getArgRegister(index++)].value; 
       if (isa<ConstantExpr>(value))
         out << "=" << value;
     }
@@ -80,6 +80,7 @@
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/CallSite.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/InstIterator.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/Process.h"
 
@@ -93,6 +94,7 @@
 #include <string>
 
 #include <sys/mman.h>
+#include <unistd.h>
 
 #include <errno.h>
 #include <cxxabi.h>
@@ -176,6 +178,31 @@ namespace {
 	cl::opt<bool>
 		AllExternalWarnings("all-external-warnings");
 
+	cl::list<std::string>
+		ExternalNoWrites("external-no-writes",
+				cl::CommaSeparated,
+				cl::desc("External functions that do not write program memory, so their calls skip copying memory back (in addition to a built-in list)"));
+
+	cl::list<std::string>
+		ExternalWritesArgs("external-writes-args",
+				cl::CommaSeparated,
+				cl::desc("External functions that only write the objects their pointer arguments point into (in addition to a built-in list)"));
+
+	cl::opt<bool>
+		ExternalSkipSyncedCopyOut("external-skip-synced-copy-out",
+				cl::desc("Before an external call, only copy out the objects changed since they were last copied to or from the host; a host write not covered by the write effects of an external then goes unnoticed (default=off)"),
+				cl::init(false));
+
+	cl::list<std::string>
+		NativeFunctions("native-functions",
+				cl::CommaSeparated,
+				cl::desc("Defined functions to run natively through the JIT when their arguments and all memory reachable from them are concrete; functions that allocate or free heap memory, directly or in their callees, are always interpreted"));
+
+	cl::opt<unsigned>
+		MaxNativeObjects("max-native-objects",
+				cl::init(1024),
+				cl::desc("Interpret a call to a native function when more than this many objects are reachable from it (default=1024)"));
+
 	cl::opt<bool>
 		OnlyOutputStatesCoveringNew("only-output-states-covering-new",
 				cl::init(false),
@@ -262,6 +289,21 @@ namespace {
 				cl::desc("Inhibit forking at memory cap (vs. random terminate) (default=on)"),
 				cl::init(true));
 
+	cl::opt<bool>
+		SpillStates("spill-states",
+				cl::desc("Spill the coldest states to disk instead of terminating them at the memory cap, and reload them once memory is available (default=off)"),
+				cl::init(false));
+
+	cl::opt<unsigned>
+		SpillReloadBatch("spill-reload-batch",
+				cl::desc("Number of spilled states to reload at a time (default=8)"),
+				cl::init(8));
+
+	cl::opt<bool>
+		PruneUnreachableStates("prune-unreachable-states",
+				cl::desc("Terminate, without output, states which can no longer reach uncovered focused code; checked at every --uncovered-update-interval (default=off)"),
+				cl::init(false));
+
 	cl::opt<bool>
 		DumpPtreeOnTerminate("dump-ptree-on-terminate",
 				cl::init(false),
@@ -307,6 +349,11 @@ namespace {
 				cl::init(true),
                 cl::desc("output bbs of focused functions to id-fbbs.txt"));
 
+	cl::opt<bool>
+		SpeculativeFork("speculative-fork",
+				cl::init(false),
+				cl::desc("At a symbolic branch of a seeded state, follow the seeds without querying the solver and check the other side only when it is selected (default=off)"));
+
     cl::opt<bool>
 		phaseTest("phase-test",
 				cl::init(false),
@@ -334,10 +381,15 @@ Executor::Executor(const InterpreterOptions &opts,
 	replayOut(0),
 	replayPath(0),    
 	usingSeeds(0),
+	blockCoverage(0),
+	suspendedStatsTracker(0),
 	atMemoryLimit(false),
+	spillRoot(0),
+	spillCount(0),
 	inhibitForking(false),
 	haltExecution(false),
 	ivcEnabled(false),
+	nativeGlobalsBound(false),
 	stateID(0),
     enableFork(_enableFork),
 	coreSolverTimeout(MaxCoreSolverTime != 0 && MaxInstructionTime != 0
@@ -424,7 +476,8 @@ const Module *Executor::setModule(llvm::Module *module,
 		statsTracker = 
 			new StatsTracker(*this,
 					interpreterHandler->getOutputFilename("assembly.ll"),
-					userSearcherRequiresMD2U());
+					userSearcherRequiresMD2U() || PruneUnreachableStates,
+					userSearcherRequiresFD2U() || PruneUnreachableStates);
 	}
 #endif
 
@@ -736,7 +789,7 @@ void Executor::branch(ExecutionState &state,
                 for (i=0; i<N; ++i) {
                     ref<ConstantExpr> res;
                     bool success = 
-                        solver->getValue(state, siit->assignment.evaluate(conditions[i]), 
+                        solver->getValue(state, siit->evaluate(conditions[i]), 
                                 res);
                     assert(success && "FIXME: Unhandled solver failure");
                     (void) success;
@@ -806,7 +859,7 @@ void Executor::branch(ExecutionState &state,
 			for (i=0; i<N; ++i) {
 				ref<ConstantExpr> res;
 				bool success = 
-					solver->getValue(state, siit->assignment.evaluate(conditions[i]), 
+					solver->getValue(state, siit->evaluate(conditions[i]), 
 							res);
 				assert(success && "FIXME: Unhandled solver failure");
 				(void) success;
@@ -887,7 +940,7 @@ Executor::fork(ExecutionState &current, ref<Expr> condition, bool isInternal) {
                 siie = seeds.end(); siit != siie; ++siit) {
             ref<ConstantExpr> res;
             bool success = 
-                solver->getValue(current, siit->assignment.evaluate(condition), res);
+                solver->getValue(current, siit->evaluate(condition), res);
             assert(success && "FIXME: Unhandled solver failure");
             (void) success;
             if (res->isTrue()) {
@@ -906,7 +959,7 @@ Executor::fork(ExecutionState &current, ref<Expr> condition, bool isInternal) {
 	if (!isSeeding && !isa<ConstantExpr>(condition) && 
 			(MaxStaticForkPct!=1. || MaxStaticSolvePct != 1. ||
 			 MaxStaticCPForkPct!=1. || MaxStaticCPSolvePct != 1.) &&
-			statsTracker->elapsed() > 60.) {
+			statsTracker && statsTracker->elapsed() > 60.) {
 		klee_xqx_debug("fork1");
 		StatisticManager &sm = *theStatisticManager;
 		CallPathNode *cpn = current.stack.back().callPathNode;
@@ -933,6 +986,13 @@ Executor::fork(ExecutionState &current, ref<Expr> condition, bool isInternal) {
 		}
 	}
 
+	if (SpeculativeFork && isSeeding && !replayPath &&
+			!isa<ConstantExpr>(condition)) {
+		StatePair result;
+		if (speculativeFork(current, condition, isInternal, result))
+			return result;
+	}
+
 	double timeout = coreSolverTimeout;
 	if (isSeeding)
 		timeout *= it->second.size();
@@ -1008,7 +1068,7 @@ Executor::fork(ExecutionState &current, ref<Expr> condition, bool isInternal) {
 				siie = it->second.end(); siit != siie; ++siit) {
 			ref<ConstantExpr> res;
 			bool success = 
-				solver->getValue(current, siit->assignment.evaluate(condition), res);
+				solver->getValue(current, siit->evaluate(condition), res);
 			assert(success && "FIXME: Unhandled solver failure");
 			(void) success;
 			if (res->isTrue()) {
@@ -1099,7 +1159,7 @@ Executor::fork(ExecutionState &current, ref<Expr> condition, bool isInternal) {
 		  klee_xqx_debug("seed branch %d-------------------",++index);
 		SeedInfo *si = &*siit;
 		//si->printSeedInfo();
-		  ref<Expr> tmp = siit->assignment.evaluate(condition);
+		  ref<Expr> tmp = siit->evaluate(condition);
           std::ostringstream info;
           info << "condition is ----------\n" << condition << "\ncondition after evaluate:-----\n";
           info << tmp << "\n" ;
@@ -1107,13 +1167,13 @@ Executor::fork(ExecutionState &current, ref<Expr> condition, bool isInternal) {
 		  /*klee_xqx_debug("condition is:-------------------");*/
 		  //condition->dump();
 		  //klee_xqx_debug("condition after evaluate:-------------------");
-		  //ref<Expr> tmp = siit->assignment.evaluate(condition);
+		  //ref<Expr> tmp = siit->evaluate(condition);
 		  /*tmp->dump();*/
 #endif
 
 				ref<ConstantExpr> res;
 				bool success = 
-					solver->getValue(current, siit->assignment.evaluate(condition), res);
+					solver->getValue(current, siit->evaluate(condition), res);
 				assert(success && "FIXME: Unhandled solver failure");
 				(void) success;
 				if (res->isTrue()) {
@@ -1135,7 +1195,7 @@ Executor::fork(ExecutionState &current, ref<Expr> condition, bool isInternal) {
 			}
 			if (swapInfo) {
 				std::swap(trueState->coveredNew, falseState->coveredNew);
-				std::swap(trueState->coveredLines, falseState->coveredLines);
+				std::swap(trueState->coveredInstructions, falseState->coveredInstructions);
 			}
 		}
 
@@ -1194,6 +1254,120 @@ Executor::fork(ExecutionState &current, ref<Expr> condition, bool isInternal) {
 	}
 }
 
+bool Executor::speculativeFork(ExecutionState &current, ref<Expr> condition,
+		bool isInternal, StatePair &result) {
+	std::map< ExecutionState*, std::vector<SeedInfo> >::iterator it = 
+		seedMap.find(&current);
+	assert(it != seedMap.end() && "speculative fork without seeds");
+	if (it->second.empty())
+		return false;
+
+	// If the seeds satisfy the path constraints, the direction they take
+	// is feasible and needs no query. Give up if any seed leaves the
+	// condition symbolic, the seeds disagree, or a seed cannot be shown
+	// to satisfy the constraints: constraints added without patching
+	// the seeds, and bytes past the end of a short seed, break that.
+	bool seedBranch = false;
+	for (std::vector<SeedInfo>::iterator siit = it->second.begin(), 
+			siie = it->second.end(); siit != siie; ++siit) {
+		ref<Expr> value = siit->evaluate(condition);
+		ConstantExpr *CE = dyn_cast<ConstantExpr>(value);
+		if (!CE)
+			return false;
+		if (siit == it->second.begin())
+			seedBranch = CE->isTrue();
+		else if (CE->isTrue() != seedBranch)
+			return false;
+	}
+	for (std::vector<SeedInfo>::iterator siit = it->second.begin(), 
+			siie = it->second.end(); siit != siie; ++siit)
+		if (!siit->satisfies(current.constraints))
+			return false;
+
+	ref<Expr> seedCondition = 
+		seedBranch ? condition : Expr::createIsZero(condition);
+
+	if (current.forkDisabled || OnlyReplaySeeds) {
+		if (!isInternal && pathWriter)
+			current.pathOS << (seedBranch ? "1" : "0");
+		addConstraint(current, seedCondition);
+		result = seedBranch ? StatePair(&current, 0) : StatePair(0, &current);
+		return true;
+	}
+
+	TimerStatIncrementer timer(stats::forkTime);
+	++stats::forks;
+	++stats::speculativeForks;
+
+	ExecutionState *otherState = current.branch(++stateID);
+	otherState->speculativeCondition = 
+		seedBranch ? Expr::createIsZero(condition) : condition;
+	addedStates.insert(otherState);
+
+	ExecutionState *trueState = seedBranch ? &current : otherState;
+	ExecutionState *falseState = seedBranch ? otherState : &current;
+
+	current.ptreeNode->data = 0;
+	std::pair<PTree::Node*, PTree::Node*> res =
+		processTree->split(current.ptreeNode, falseState, trueState, condition);
+	falseState->ptreeNode = res.first;
+	trueState->ptreeNode = res.second;
+
+	if (!isInternal) {
+		if (pathWriter) {
+			otherState->pathOS = pathWriter->open(current.pathOS);
+			trueState->pathOS << "1";
+			falseState->pathOS << "0";
+		}      
+		if (symPathWriter) {
+			otherState->symPathOS = symPathWriter->open(current.symPathOS);
+			trueState->symPathOS << "1";
+			falseState->symPathOS << "0";
+		}
+	}
+
+	addConstraint(current, seedCondition);
+
+	// As in fork(), the concolic searcher is told to prefer the new
+	// states only when the seeds take the true branch.
+	if (UseConcreteData && UseConcolicSearcher && seedBranch)
+		searcher->setFlags(true);
+
+	if (MaxDepth && MaxDepth<=current.depth) {
+		terminateStateEarly(current, "max-depth exceeded.");
+		terminateStateEarly(*otherState, "max-depth exceeded.");
+		result = StatePair(0, 0);
+		return true;
+	}
+
+	result = StatePair(trueState, falseState);
+	return true;
+}
+
+bool Executor::resolveSpeculativeState(ExecutionState &state) {
+	ref<Expr> condition = state.speculativeCondition;
+	state.speculativeCondition = ref<Expr>();
+
+	bool feasible;
+	solver->setTimeout(coreSolverTimeout);
+	bool success = solver->mayBeTrue(state, condition, feasible);
+	solver->setTimeout(0);
+	if (!success) {
+		klee_warning_once(0, "query timed out (speculative fork), dropping state");
+		terminateState(state);
+		return false;
+	}
+
+	if (!feasible) {
+		++stats::speculativeDiscards;
+		terminateState(state);
+		return false;
+	}
+
+	addConstraint(state, condition);
+	return true;
+}
+
 void Executor::addConstraint(ExecutionState &state, ref<Expr> condition) {
 	//condition->dump();
 	if (ConstantExpr *CE = dyn_cast<ConstantExpr>(condition)) {
@@ -1210,7 +1384,7 @@ void Executor::addConstraint(ExecutionState &state, ref<Expr> condition) {
 				siie = it->second.end(); siit != siie; ++siit) {
 			bool res;
 			bool success = 
-				solver->mustBeFalse(state, siit->assignment.evaluate(condition), res);
+				solver->mustBeFalse(state, siit->evaluate(condition), res);
 			assert(success && "FIXME: Unhandled solver failure");
 			(void) success;
 			if (res) {
@@ -1310,7 +1484,7 @@ const Cell& Executor::eval(KInstruction *ki, unsigned index,
 	} else {
 		unsigned index = vnumber;
 		StackFrame &sf = state.stack.back();
-		return sf.locals[index];
+		return (*sf.locals)[index];
 	}
 }
 
@@ -1395,7 +1569,7 @@ void Executor::executeGetValue(ExecutionState &state,
 				siie = it->second.end(); siit != siie; ++siit) {
 			ref<ConstantExpr> value;
 			bool success = 
-				solver->getValue(state, siit->assignment.evaluate(e), value);
+				solver->getValue(state, siit->evaluate(e), value);
 			assert(success && "FIXME: Unhandled solver failure");
 			(void) success;
 			values.insert(value);
@@ -1444,6 +1618,7 @@ void Executor::stepInstruction(ExecutionState &state) {
 		statsTracker->stepInstruction(state);
 
 	++stats::instructions;
+	++state.steppedInstructions;
 	state.prevPC = state.pc;
 	++state.pc;
 
@@ -1587,6 +1762,8 @@ void Executor::executeCall(ExecutionState &state,
 	}
 	else {
 		//klee_message("[xqx]: executeCall which is not declaration, func = %s ", f->getName().data());
+		if (!NativeFunctions.empty() && callNativeFunction(state, ki, f, arguments))
+			return;
 
 		// FIXME: I'm not really happy about this reliance on prevPC but it is ok, I
 		// guess. This just done to avoid having to pass KInstIterator everywhere
@@ -1595,6 +1772,8 @@ void Executor::executeCall(ExecutionState &state,
 		KFunction *kf = kmodule->functionMap[f];
 		state.pushFrame(state.prevPC, kf);
 		state.pc = kf->instructions;
+		if (blockCoverage)
+			recordBlockEntry(kf->instructions[0]);
 
 		if (statsTracker)
 			statsTracker->framePushed(state, &state.stack[state.stack.size()-2]);
@@ -1682,6 +1861,14 @@ void Executor::executeCall(ExecutionState &state,
 
 void Executor::transferToBasicBlock(BasicBlock *dst, BasicBlock *src, 
 		ExecutionState &state) {
+	// Branches and switches use the entries pre-resolved in
+	// KInstruction::successors instead of this lookup.
+	KFunction *kf = state.stack.back().kf;
+	transferToBlockEntry(kf->basicBlockEntry[dst], src, state);
+}
+
+void Executor::transferToBlockEntry(unsigned entry, BasicBlock *src,
+		ExecutionState &state) {
 	// Note that in general phi nodes can reuse phi values from the same
 	// block but the incoming value is the eval() result *before* the
 	// execution of any phi nodes. this is pathological and doesn't
@@ -1693,15 +1880,36 @@ void Executor::transferToBasicBlock(BasicBlock *dst, BasicBlock *src,
 	//
 	// With that done we simply set an index in the state so that PHI
 	// instructions know which argument to eval, set the pc, and continue.
-
-	// XXX this lookup has to go ?
 	KFunction *kf = state.stack.back().kf;
-	unsigned entry = kf->basicBlockEntry[dst];
 	state.pc = &kf->instructions[entry];
-	if (state.pc->inst->getOpcode() == Instruction::PHI) {
+	if (state.pc->opcode == Instruction::PHI) {
 		PHINode *first = static_cast<PHINode*>(state.pc->inst);
 		state.incomingBBIndex = first->getBasicBlockIndex(src);
 	}
+	if (blockCoverage)
+		recordBlockEntry(kf->instructions[entry]);
+}
+
+void Executor::setBlockCoverage(std::vector<bool> *blocks) {
+	// The replays recording block coverage produce no test cases, so the
+	// coverage statistics must not see them either: run.istats would
+	// report code no test reaches, and the states exploring later would
+	// not count as covering new code.
+	if (blocks && !blockCoverage) {
+		suspendedStatsTracker = statsTracker;
+		statsTracker = 0;
+	} else if (!blocks && blockCoverage) {
+		statsTracker = suspendedStatsTracker;
+		suspendedStatsTracker = 0;
+	}
+	blockCoverage = blocks;
+}
+
+void Executor::recordBlockEntry(KInstruction *ki) {
+	unsigned id = ki->info->id;
+	if (id >= blockCoverage->size())
+		blockCoverage->resize(std::max(id + 1, kmodule->infos->getMaxID()));
+	(*blockCoverage)[id] = true;
 }
 
 void Executor::printFileLine(ExecutionState &state, KInstruction *ki) {
@@ -1779,7 +1987,7 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
 	//i->dump();
 	//klee_message("[xqx]=============================\n");
 
-	switch (i->getOpcode()) {
+	switch (ki->opcode) {
 		// Control flow
 		case Instruction::Ret:
 			{
@@ -1892,12 +2100,13 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
 			{
 				BranchInst *bi = cast<BranchInst>(i);
 				if (bi->isUnconditional()) {
-					transferToBasicBlock(bi->getSuccessor(0), bi->getParent(), state);
+					transferToBlockEntry(ki->successors[0], bi->getParent(), state);
 				} else {
 					// FIXME: Find a way that we don't have this hidden dependency.
 					assert(bi->getCondition() == bi->getOperand(0) &&
 							"Wrong operand index!");
 					ref<Expr> cond = eval(ki, 0, state).value;
+					recordBranchInputBytes(state, cond);
 					Executor::StatePair branches = fork(state, cond, false);
 
 					// NOTE: There is a hidden dependency here, markBranchVisited
@@ -1908,9 +2117,9 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
 						statsTracker->markBranchVisited(branches.first, branches.second);
 
                     if (branches.first)
-                        transferToBasicBlock(bi->getSuccessor(0), bi->getParent(), *branches.first);
+                        transferToBlockEntry(ki->successors[0], bi->getParent(), *branches.first);
                     if (branches.second)
-                        transferToBasicBlock(bi->getSuccessor(1), bi->getParent(), *branches.second);
+                        transferToBlockEntry(ki->successors[1], bi->getParent(), *branches.second);
 #if 0
                     if( concolicBr ) {
                         if (branches.first)
@@ -1935,6 +2144,7 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
 				ref<Expr> cond = eval(ki, 0, state).value;
 				BasicBlock *bb = si->getParent();
 
+				recordBranchInputBytes(state, cond);
 				cond = toUnique(state, cond);
 				if (ConstantExpr *CE = dyn_cast<ConstantExpr>(cond)) {
 					// Somewhat gross to create these all the time, but fine till we
@@ -1947,66 +2157,63 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
 #else
 					unsigned index = si->findCaseValue(ci);
 #endif
-					transferToBasicBlock(si->getSuccessor(index), si->getParent(), state);
+					transferToBlockEntry(ki->successors[index], si->getParent(), state);
 				} else {
+					// Collect the condition for reaching each successor and check
+					// them all against the path condition in one batched query.
 					std::map<BasicBlock*, ref<Expr> > targets;
 					ref<Expr> isDefault = ConstantExpr::alloc(1, Expr::Bool);
 #if LLVM_VERSION_CODE >= LLVM_VERSION(3, 1)      
 					for (SwitchInst::CaseIt i = si->case_begin(), e = si->case_end();
 							i != e; ++i) {
 						ref<Expr> value = evalConstant(i.getCaseValue());
+						BasicBlock *caseSuccessor = i.getCaseSuccessor();
 #else
-						for (unsigned i=1, cases = si->getNumCases(); i<cases; ++i) {
-							ref<Expr> value = evalConstant(si->getCaseValue(i));
-#endif
-							ref<Expr> match = EqExpr::create(cond, value);
-							isDefault = AndExpr::create(isDefault, Expr::createIsZero(match));
-							bool result;
-							bool success = solver->mayBeTrue(state, match, result);
-							assert(success && "FIXME: Unhandled solver failure");
-							(void) success;
-							if (result) {
-#if LLVM_VERSION_CODE >= LLVM_VERSION(3, 1)
-								BasicBlock *caseSuccessor = i.getCaseSuccessor();
-#else
-								BasicBlock *caseSuccessor = si->getSuccessor(i);
+					for (unsigned i=1, cases = si->getNumCases(); i<cases; ++i) {
+						ref<Expr> value = evalConstant(si->getCaseValue(i));
+						BasicBlock *caseSuccessor = si->getSuccessor(i);
 #endif
-								std::map<BasicBlock*, ref<Expr> >::iterator it =
-									targets.insert(std::make_pair(caseSuccessor,
-												ConstantExpr::alloc(0, Expr::Bool))).first;
-
-								it->second = OrExpr::create(match, it->second);
-							}
-#if LLVM_VERSION_CODE >= LLVM_VERSION(3, 1)      
-						}
-#else
+						ref<Expr> match = EqExpr::create(cond, value);
+						isDefault = AndExpr::create(isDefault, Expr::createIsZero(match));
+						std::map<BasicBlock*, ref<Expr> >::iterator it =
+							targets.insert(std::make_pair(caseSuccessor,
+										ConstantExpr::alloc(0, Expr::Bool))).first;
+						it->second = OrExpr::create(match, it->second);
 					}
-#endif
-					bool res;
-					bool success = solver->mayBeTrue(state, isDefault, res);
+					std::map<BasicBlock*, ref<Expr> >::iterator dit =
+						targets.insert(std::make_pair(si->getDefaultDest(),
+									ConstantExpr::alloc(0, Expr::Bool))).first;
+					dit->second = OrExpr::create(isDefault, dit->second);
+
+					std::vector< ref<Expr> > candidates;
+					for (std::map<BasicBlock*, ref<Expr> >::iterator it = 
+							targets.begin(), ie = targets.end();
+							it != ie; ++it)
+						candidates.push_back(it->second);
+
+					std::vector<bool> feasible;
+					bool success = solver->mayBeTrue(state, candidates, feasible);
 					assert(success && "FIXME: Unhandled solver failure");
 					(void) success;
-					if (res)
-						targets.insert(std::make_pair(si->getDefaultDest(), isDefault));
 
 					std::vector< ref<Expr> > conditions;
+					std::vector<BasicBlock*> successors;
+					unsigned index = 0;
 					for (std::map<BasicBlock*, ref<Expr> >::iterator it = 
 							targets.begin(), ie = targets.end();
-							it != ie; ++it)
-						conditions.push_back(it->second);
+							it != ie; ++it, ++index) {
+						if (feasible[index]) {
+							conditions.push_back(it->second);
+							successors.push_back(it->first);
+						}
+					}
 
 					std::vector<ExecutionState*> branches;
 					branch(state, conditions, branches);
 
-					std::vector<ExecutionState*>::iterator bit = branches.begin();
-					for (std::map<BasicBlock*, ref<Expr> >::iterator it = 
-							targets.begin(), ie = targets.end();
-							it != ie; ++it) {
-						ExecutionState *es = *bit;
-						if (es)
-							transferToBasicBlock(it->first, bb, *es);
-						++bit;
-					}
+					for (unsigned j = 0; j < successors.size(); ++j)
+						if (branches[j])
+							transferToBasicBlock(successors[j], bb, *branches[j]);
 				}
 				break;
 			}
@@ -2497,42 +2704,36 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
 			// Conversion
 		case Instruction::Trunc: 
 			{
-				CastInst *ci = cast<CastInst>(i);
 				ref<Expr> result = ExtractExpr::create(eval(ki, 0, state).value,
-						0,
-						getWidthForLLVMType(ci->getType()));
+						0, ki->width);
 				bindLocal(ki, state, result);
 				break;
 			}
 		case Instruction::ZExt: 
 			{
-				CastInst *ci = cast<CastInst>(i);
 				ref<Expr> result = ZExtExpr::create(eval(ki, 0, state).value,
-						getWidthForLLVMType(ci->getType()));
+						ki->width);
 				bindLocal(ki, state, result);
 				break;
 			}
 		case Instruction::SExt: 
 			{
-				CastInst *ci = cast<CastInst>(i);
 				ref<Expr> result = SExtExpr::create(eval(ki, 0, state).value,
-						getWidthForLLVMType(ci->getType()));
+						ki->width);
 				bindLocal(ki, state, result);
 				break;
 			}
 
 		case Instruction::IntToPtr: 
 			{
-				CastInst *ci = cast<CastInst>(i);
-				Expr::Width pType = getWidthForLLVMType(ci->getType());
+				Expr::Width pType = ki->width;
 				ref<Expr> arg = eval(ki, 0, state).value;
 				bindLocal(ki, state, ZExtExpr::create(arg, pType));
 				break;
 			} 
 		case Instruction::PtrToInt: 
 			{
-				CastInst *ci = cast<CastInst>(i);
-				Expr::Width iType = getWidthForLLVMType(ci->getType());
+				Expr::Width iType = ki->width;
 				ref<Expr> arg = eval(ki, 0, state).value;
 				bindLocal(ki, state, ZExtExpr::create(arg, iType));
 				break;
@@ -2903,7 +3104,7 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
 
 				ref<Expr> agg = eval(ki, 0, state).value;
 
-				ref<Expr> result = ExtractExpr::create(agg, kgepi->offset*8, getWidthForLLVMType(i->getType()));
+				ref<Expr> result = ExtractExpr::create(agg, kgepi->offset*8, ki->width);
 
 				bindLocal(ki, state, result);
 				break;
@@ -2947,6 +3148,7 @@ void Executor::updateStates(ExecutionState *current) {
 			seedMap.find(es);
 		if (it3 != seedMap.end())
 			seedMap.erase(it3);
+		resumingStates.erase(es);
 		processTree->remove(es->ptreeNode);
 		delete es;
 	}
@@ -3024,14 +3226,27 @@ void Executor::run(ExecutionState &initialState) {
 
 	states.insert(&initialState);
 
-	if (usingSeeds) {
+	if (MaxMemory && SpillStates) {
+		spillRoot = new ExecutionState(initialState);
+		spillRoot->ptreeNode = 0;
+	}
+
+	if (usingSeeds || interpreterOpts.InferSymRanges) {
 		std::vector<SeedInfo> &v = seedMap[&initialState];
 
-		for (std::vector<KTest*>::const_iterator it = usingSeeds->begin(), 
-				ie = usingSeeds->end(); it != ie; ++it)
-			v.push_back(SeedInfo(*it));
+		if (usingSeeds) {
+			for (std::vector<KTest*>::const_iterator it = usingSeeds->begin(), 
+					ie = usingSeeds->end(); it != ie; ++it)
+				v.push_back(SeedInfo(*it));
+		} else {
+			// Follow the concrete path of the concolic files only: their
+			// objects are seeded with the file contents in
+			// executeMakeSymbolic(), and the seeded state never forks.
+			v.push_back(SeedInfo(NULL));
+			initialState.forkDisabled = true;
+		}
 
-		int lastNumSeeds = usingSeeds->size()+10;
+		int lastNumSeeds = v.size()+10;
 		double lastTime, startTime = lastTime = util::getWallTime();
 		ExecutionState *lastState = 0;
 		while (!seedMap.empty()) {
@@ -3084,7 +3299,7 @@ void Executor::run(ExecutionState &initialState) {
 			(*it)->weight = 1.;
 		}
 
-		if (OnlySeed)
+		if (OnlySeed || interpreterOpts.InferSymRanges)
 			goto dump;
 	}
 
@@ -3112,6 +3327,17 @@ void Executor::run(ExecutionState &initialState) {
 		}
 #endif
 
+		if (!state.speculativeCondition.isNull() &&
+				!resolveSpeculativeState(state)) {
+			updateStates(&state);
+			continue;
+		}
+
+		if (!resumingStates.empty() && !checkSpillResumePoint(state)) {
+			updateStates(&state);
+			continue;
+		}
+
 		KInstruction *ki = state.pc;
 #ifdef XQX_FORKCHECK
         if( forkOnlyFocusFunc )
@@ -3134,42 +3360,23 @@ void Executor::run(ExecutionState &initialState) {
                 mbs = mbs >> 20;
 #endif
 				if (mbs > MaxMemory) {
-					if (mbs > MaxMemory + 100) {
-						// just guess at how many to kill
-						unsigned numStates = states.size();
-						unsigned toKill = std::max(1U, numStates - numStates*MaxMemory/mbs);
-
-                        unsigned maxMem = MaxMemory;
-                        klee_xqx_debug("curMem=%d, MaxMem=%d", mbs, maxMem);
-                        klee_xqx_debug("kill %d states in %d", toKill ,numStates);
-                        if(toKill==numStates)
-                            toKill = numStates / 2; //we kill half of all
-
-						if (MaxMemoryInhibit)
-							klee_warning("killing %d states (over memory cap)",
-									toKill);
-
-						std::vector<ExecutionState*> arr(states.begin(), states.end());
-						for (unsigned i=0,N=arr.size(); N && i<toKill; ++i,--N) {
-							unsigned idx = rand() % N;
-
-							// Make two pulls to try and not hit a state that
-							// covered new code.
-							if (arr[idx]->coveredNew)
-								idx = rand() % N;
-
-							std::swap(arr[idx], arr[N-1]);
-							terminateStateEarly(*arr[N-1], "Memory limit exceeded.");
-						}
-					}
+					if (mbs > MaxMemory + 100)
+						shedStates(mbs);
 					atMemoryLimit = true;
 				} else {
 					atMemoryLimit = false;
+					if (!spilledStates.empty() && mbs < MaxMemory * 3 / 4)
+						reloadSpilledStates(SpillReloadBatch);
 				}
 			}
 		}
 
 		updateStates(&state);
+
+		if (states.empty() && !spilledStates.empty() && !haltExecution) {
+			reloadSpilledStates(SpillReloadBatch);
+			updateStates(0);
+		}
 	}
 
 	delete searcher;
@@ -3187,6 +3394,225 @@ dump:
 		}
 		updateStates(0);
 	}
+
+	if (spillRoot) {
+		// The spill files are inputs reaching the middle of a path, not
+		// test cases; remove those that were never reloaded.
+		if (!spilledStates.empty())
+			klee_message("%d spilled states were not reloaded",
+					(int) spilledStates.size());
+		for (std::deque<SpillPoint>::iterator it = spilledStates.begin(),
+				ie = spilledStates.end(); it != ie; ++it)
+			unlink(it->path.c_str());
+		spilledStates.clear();
+		resumingStates.clear();
+		for (std::vector<KTest*>::iterator it = reloadedInputs.begin(),
+				ie = reloadedInputs.end(); it != ie; ++it)
+			kTest_free(*it);
+		reloadedInputs.clear();
+		delete spillRoot;
+		spillRoot = 0;
+	}
+}
+
+namespace {
+	/// Orders states so that those which have gone longest without
+	/// covering new code come first.
+	struct ColderState {
+		bool operator()(const ExecutionState *a, const ExecutionState *b) const {
+			if (a->coveredNew != b->coveredNew)
+				return !a->coveredNew;
+			return a->instsSinceCovNew > b->instsSinceCovNew;
+		}
+	};
+}
+
+void Executor::pruneUnreachableStates(unsigned numFocusedUncovered) {
+	// Without an uncovered focused instruction every distance is zero,
+	// which says nothing about the states.
+	if (!PruneUnreachableStates || !numFocusedUncovered)
+		return;
+	// The tracker's timers keep running while seeds are replayed to
+	// distill them; those replays must run to the end.
+	if (blockCoverage)
+		return;
+
+	// The distances account for returning through every frame of the
+	// stack, so a state in a focused function is pruned just the same.
+	unsigned pruned = 0;
+	for (std::set<ExecutionState*>::iterator it = states.begin(),
+			ie = states.end(); it != ie; ++it) {
+		ExecutionState *es = *it;
+		// called from processTimers, before the terminated states of
+		// the last step have been removed
+		if (removedStates.count(es))
+			continue;
+		if (computeMinDistToFocusedUncovered(es->pc,
+					es->stack.back().minDistToFocusedOnReturn))
+			continue;
+
+		terminateState(*es);
+		++stats::prunedStates;
+		++pruned;
+	}
+
+	if (pruned)
+		klee_message("pruned %u states unable to reach uncovered focused code",
+				pruned);
+}
+
+void Executor::shedStates(unsigned mbs) {
+	// just guess at how many to kill
+	unsigned numStates = states.size();
+	unsigned toKill = std::max(1U, numStates - numStates*MaxMemory/mbs);
+
+	unsigned maxMem = MaxMemory;
+	klee_xqx_debug("curMem=%d, MaxMem=%d", mbs, maxMem);
+	klee_xqx_debug("kill %d states in %d", toKill ,numStates);
+	if(toKill==numStates)
+		toKill = numStates / 2; //we kill half of all
+
+	std::vector<ExecutionState*> arr(states.begin(), states.end());
+
+	if (spillRoot) {
+		std::partial_sort(arr.begin(), arr.begin() + toKill, arr.end(),
+				ColderState());
+		unsigned numSpilled = 0;
+		for (unsigned i=0; i<toKill; ++i) {
+			if (removedStates.count(arr[i]))
+				continue;
+			if (spillState(*arr[i]))
+				++numSpilled;
+			else
+				terminateStateEarly(*arr[i], "Memory limit exceeded.");
+		}
+		if (MaxMemoryInhibit)
+			klee_warning("spilling %d states (over memory cap)", numSpilled);
+		return;
+	}
+
+	if (MaxMemoryInhibit)
+		klee_warning("killing %d states (over memory cap)",
+				toKill);
+
+	for (unsigned i=0,N=arr.size(); N && i<toKill; ++i,--N) {
+		unsigned idx = rand() % N;
+
+		// Make two pulls to try and not hit a state that
+		// covered new code.
+		if (arr[idx]->coveredNew)
+			idx = rand() % N;
+
+		std::swap(arr[idx], arr[N-1]);
+		terminateStateEarly(*arr[N-1], "Memory limit exceeded.");
+	}
+}
+
+bool Executor::spillState(ExecutionState &state) {
+	// An infeasible speculative state is simply dropped.
+	if (!state.speculativeCondition.isNull() &&
+			!resolveSpeculativeState(state))
+		return true;
+
+	std::vector< 
+		std::pair<std::string,
+		std::vector<unsigned char> > > out;
+	if (!getSymbolicSolution(state, out))
+		return false;
+
+	KTest b;
+	b.numArgs = 0;
+	b.args = 0;
+	b.symArgvs = 0;
+	b.symArgvLen = 0;
+	b.numObjects = out.size();
+	b.objects = new KTestObject[b.numObjects];
+	for (unsigned i=0; i<b.numObjects; i++) {
+		KTestObject *o = &b.objects[i];
+		o->name = const_cast<char*>(out[i].first.c_str());
+		o->numBytes = out[i].second.size();
+		o->bytes = new unsigned char[o->numBytes];
+		std::copy(out[i].second.begin(), out[i].second.end(), o->bytes);
+	}
+
+	char name[32];
+	sprintf(name, "spill%06d.ktest", ++spillCount);
+	std::string path = interpreterHandler->getOutputFilename(name);
+	bool written = kTest_toFile(&b, path.c_str());
+
+	for (unsigned i=0; i<b.numObjects; i++)
+		delete[] b.objects[i].bytes;
+	delete[] b.objects;
+
+	if (!written) {
+		klee_warning("unable to write spilled state to %s", path.c_str());
+		return false;
+	}
+
+	SpillPoint sp;
+	sp.path = path;
+	sp.steppedInstructions = state.steppedInstructions;
+	sp.pcId = state.pc->info->id;
+	sp.stackDepth = state.stack.size();
+	spilledStates.push_back(sp);
+	terminateState(state);
+	return true;
+}
+
+void Executor::reloadSpilledStates(unsigned count) {
+	assert(spillRoot && "reloading without a spill root");
+
+	for (unsigned i=0; i<count && !spilledStates.empty(); ++i) {
+		SpillPoint spilled = spilledStates.front();
+		spilledStates.pop_front();
+
+		KTest *input = kTest_fromFile(spilled.path.c_str());
+		if (!input) {
+			klee_warning("unable to read spilled state %s, losing it",
+					spilled.path.c_str());
+			continue;
+		}
+		unlink(spilled.path.c_str());
+		reloadedInputs.push_back(input);
+
+		// The state is re-derived by following its input from the
+		// initial state without forking, which rebuilds its constraints
+		// and memory. It is grafted beside the existing process tree.
+		ExecutionState *es = new ExecutionState(*spillRoot);
+		es->id = ++stateID;
+		es->forkDisabled = true;
+		es->ptreeNode = processTree->graft(es);
+		seedMap[es].push_back(SeedInfo(input));
+		resumingStates[es] = spilled;
+		addedStates.insert(es);
+	}
+}
+
+bool Executor::checkSpillResumePoint(ExecutionState &state) {
+	std::map<ExecutionState*, SpillPoint>::iterator it = 
+		resumingStates.find(&state);
+	if (it == resumingStates.end() ||
+			state.steppedInstructions < it->second.steppedInstructions)
+		return true;
+
+	// The replay may diverge from the spilled path, e.g. through an
+	// external call returning something else; the state it reaches is
+	// then not the one that was spilled.
+	SpillPoint sp = it->second;
+	bool diverged = state.steppedInstructions != sp.steppedInstructions ||
+		state.pc->info->id != sp.pcId ||
+		state.stack.size() != sp.stackDepth;
+	resumingStates.erase(it);
+	seedMap.erase(&state);
+	state.forkDisabled = false;
+
+	if (diverged) {
+		klee_warning("reloaded state diverged from %s, dropping it",
+				sp.path.c_str());
+		terminateState(state);
+		return false;
+	}
+	return true;
 }
 
 std::string Executor::getAddressInfo(ExecutionState &state, 
@@ -3326,6 +3752,7 @@ void Executor::terminateState(ExecutionState &state) {
 			seedMap.find(&state);
 		if (it3 != seedMap.end())
 			seedMap.erase(it3);
+		resumingStates.erase(&state);
 		addedStates.erase(it);
         //addbyxqx201511 if addedState to be removed, not swap yet
         searcher->setFlags(false);
@@ -3336,6 +3763,12 @@ void Executor::terminateState(ExecutionState &state) {
 
 void Executor::terminateStateEarly(ExecutionState &state, 
 		const Twine &message) {
+	// A speculative state may turn out to be infeasible, in which case
+	// it must not produce a test case.
+	if (!state.speculativeCondition.isNull() &&
+			!resolveSpeculativeState(state))
+		return;
+
 	if (!OnlyOutputStatesCoveringNew || state.coveredNew ||
 			(AlwaysOutputSeeds && seedMap.count(&state)))
 		interpreterHandler->processTestCase(state, (message + "\n").str().c_str(),
@@ -3443,6 +3876,79 @@ static std::set<std::string> okExternals(okExternalsList,
 		okExternalsList + 
 		(sizeof(okExternalsList)/sizeof(okExternalsList[0])));
 
+/// What an external function may write in program memory, apart from its
+/// return value. Functions without an entry may write anything, so all
+/// objects have to be compared after the call.
+enum ExternalWriteEffect {
+	ExternalWritesAnything,
+	ExternalWritesNothing,
+	ExternalWritesPointerArgs
+};
+
+static const struct {
+	const char *name;
+	ExternalWriteEffect effect;
+} externalWriteEffectsList[] = {
+	{ "abs", ExternalWritesNothing },
+	{ "close", ExternalWritesNothing },
+	{ "getegid", ExternalWritesNothing },
+	{ "geteuid", ExternalWritesNothing },
+	{ "getgid", ExternalWritesNothing },
+	{ "getpid", ExternalWritesNothing },
+	{ "getppid", ExternalWritesNothing },
+	{ "getuid", ExternalWritesNothing },
+	{ "memcmp", ExternalWritesNothing },
+	{ "putchar", ExternalWritesNothing },
+	{ "puts", ExternalWritesNothing },
+	{ "sleep", ExternalWritesNothing },
+	{ "strcmp", ExternalWritesNothing },
+	{ "strlen", ExternalWritesNothing },
+	{ "strncmp", ExternalWritesNothing },
+	{ "usleep", ExternalWritesNothing },
+	{ "write", ExternalWritesNothing },
+	{ "printf", ExternalWritesAnything },	// %n
+	{ "clock_gettime", ExternalWritesPointerArgs },
+	{ "fflush", ExternalWritesPointerArgs },
+	{ "fgets", ExternalWritesPointerArgs },
+	{ "fprintf", ExternalWritesPointerArgs },
+	{ "fputc", ExternalWritesPointerArgs },
+	{ "fputs", ExternalWritesPointerArgs },
+	{ "fread", ExternalWritesPointerArgs },
+	{ "fstat", ExternalWritesPointerArgs },
+	{ "fwrite", ExternalWritesPointerArgs },
+	{ "getcwd", ExternalWritesPointerArgs },
+	{ "gettimeofday", ExternalWritesPointerArgs },
+	{ "lstat", ExternalWritesPointerArgs },
+	{ "memcpy", ExternalWritesPointerArgs },
+	{ "memmove", ExternalWritesPointerArgs },
+	{ "memset", ExternalWritesPointerArgs },
+	{ "read", ExternalWritesPointerArgs },
+	{ "snprintf", ExternalWritesPointerArgs },
+	{ "sprintf", ExternalWritesPointerArgs },
+	{ "stat", ExternalWritesPointerArgs },
+	{ "strcpy", ExternalWritesPointerArgs },
+	{ "strncpy", ExternalWritesPointerArgs },
+	{ "time", ExternalWritesPointerArgs }
+};
+
+static ExternalWriteEffect getExternalWriteEffect(const std::string &name) {
+	static std::map<std::string, ExternalWriteEffect> effects;
+	if (effects.empty()) {
+		for (unsigned i = 0; 
+				i != sizeof(externalWriteEffectsList)/sizeof(externalWriteEffectsList[0]);
+				++i)
+			effects[externalWriteEffectsList[i].name] = 
+				externalWriteEffectsList[i].effect;
+		for (unsigned i = 0; i != ExternalWritesArgs.size(); ++i)
+			effects[ExternalWritesArgs[i]] = ExternalWritesPointerArgs;
+		for (unsigned i = 0; i != ExternalNoWrites.size(); ++i)
+			effects[ExternalNoWrites[i]] = ExternalWritesNothing;
+	}
+
+	std::map<std::string, ExternalWriteEffect>::iterator it = effects.find(name);
+	return it == effects.end() ? ExternalWritesAnything : it->second;
+}
+
 void Executor::callExternalFunction(ExecutionState &state,
 		KInstruction *target,
 		Function *function,
@@ -3465,8 +3971,15 @@ void Executor::callExternalFunction(ExecutionState &state,
 	uint64_t *args = (uint64_t*) alloca(2*sizeof(*args) * (arguments.size() + 1));
 	memset(args, 0, 2 * sizeof(*args) * (arguments.size() + 1));
 	unsigned wordIndex = 2;
+	// Pointer arguments, in case the call only writes through them. The
+	// types are taken from the call site to include variadic arguments.
+	CallSite cs(target->inst);
+	std::vector<uint64_t> pointerArgs;
 	for (std::vector<ref<Expr> >::iterator ai = arguments.begin(), 
 			ae = arguments.end(); ai!=ae; ++ai) {
+		unsigned argNo = ai - arguments.begin();
+		bool isPointer = argNo < cs.arg_size() &&
+			cs.getArgument(argNo)->getType()->isPointerTy();
 		if (AllowExternalSymCalls) { // don't bother checking uniqueness
 			ref<ConstantExpr> ce;
 			bool success = solver->getValue(state, *ai, ce);
@@ -3474,12 +3987,16 @@ void Executor::callExternalFunction(ExecutionState &state,
 			(void) success;
 			ce->toMemory(&args[wordIndex]);
 			wordIndex += (ce->getWidth()+63)/64;
+			if (isPointer)
+				pointerArgs.push_back(ce->getZExtValue());
 		} else {
 			ref<Expr> arg = toUnique(state, *ai);
 			if (ConstantExpr *ce = dyn_cast<ConstantExpr>(arg)) {
 				// XXX kick toMemory functions from here
 				ce->toMemory(&args[wordIndex]);
 				wordIndex += (ce->getWidth()+63)/64;
+				if (isPointer)
+					pointerArgs.push_back(ce->getZExtValue());
 			} else {
 				terminateStateOnExecError(state, 
 						"external call with symbolic argument: " + 
@@ -3489,7 +4006,7 @@ void Executor::callExternalFunction(ExecutionState &state,
 		}
 	}
 
-	state.addressSpace.copyOutConcretes();
+	state.addressSpace.copyOutConcretes(ExternalSkipSyncedCopyOut);
 
 	if (!SuppressExternalWarnings) {
 		std::ostringstream os;
@@ -3514,7 +4031,19 @@ void Executor::callExternalFunction(ExecutionState &state,
 		return;
 	}
 
-	if (!state.addressSpace.copyInConcretes()) {
+	// Only compare the objects the call may have written.
+	bool copiedIn = true;
+	switch (getExternalWriteEffect(function->getName())) {
+	case ExternalWritesNothing:
+		break;
+	case ExternalWritesPointerArgs:
+		copiedIn = state.addressSpace.copyInConcretes(pointerArgs);
+		break;
+	default:
+		copiedIn = state.addressSpace.copyInConcretes();
+		break;
+	}
+	if (!copiedIn) {
 		terminateStateOnError(state, "external modified read-only object",
 				"external.err");
 		return;
@@ -3528,6 +4057,185 @@ void Executor::callExternalFunction(ExecutionState &state,
 	}
 }
 
+/// Collect the global variables referenced by v, which is an operand
+/// other than a callee. Fails on references to functions, since native
+/// code would see the function's host address rather than the address
+/// KLEE uses for it.
+static bool collectNativeGlobals(Value *v, 
+		std::set<const GlobalValue*> &globals) {
+	if (GlobalValue *gv = dyn_cast<GlobalValue>(v)) {
+		if (gv->getType()->getElementType()->isFunctionTy())
+			return false;
+		globals.insert(gv);
+	} else if (Constant *c = dyn_cast<Constant>(v)) {
+		for (User::op_iterator it = c->op_begin(), ie = c->op_end(); it != ie; ++it)
+			if (!collectNativeGlobals(*it, globals))
+				return false;
+	}
+	return true;
+}
+
+/// Externals managing heap memory. Memory allocated by native code would
+/// be unknown to the address space, and memory it frees would still be
+/// bound there, so functions calling these are never run natively.
+static const char *nativeHeapFunctionsList[] = {
+	"aligned_alloc", "asprintf", "calloc", "free", "getdelim", "getline",
+	"malloc", "memalign", "posix_memalign", "realloc", "realpath",
+	"strdup", "strndup", "valloc", "vasprintf",
+	"_Znaj", "_Znam", "_Znwj", "_Znwm", "_ZdaPv", "_ZdlPv"
+};
+static std::set<std::string> nativeHeapFunctions(nativeHeapFunctionsList,
+		nativeHeapFunctionsList + 
+		(sizeof(nativeHeapFunctionsList)/sizeof(nativeHeapFunctionsList[0])));
+
+bool Executor::isNativeCallable(Function *f) {
+	std::map<const Function*, bool>::iterator it = nativeCallable.find(f);
+	if (it != nativeCallable.end())
+		return it->second;
+
+	// f and every function it calls directly must be defined, not part of
+	// the runtime and not focused; calls leaving the module must go to
+	// functions KLEE would also call externally.
+	bool callable = !f->isVarArg();
+	std::set<const GlobalValue*> globals;
+	std::set<Function*> visited;
+	std::vector<Function*> worklist(1, f);
+	visited.insert(f);
+	while (callable && !worklist.empty()) {
+		Function *g = worklist.back();
+		worklist.pop_back();
+		if (kmodule->internalFunctions.count(g) || 
+				kmodule->functionMap[g]->isFocusedFunc) {
+			callable = false;
+			break;
+		}
+
+		for (inst_iterator i = inst_begin(g), ie = inst_end(g); 
+				callable && i != ie; ++i) {
+			Instruction *inst = &*i;
+			if (!isa<CallInst>(inst) && !isa<InvokeInst>(inst)) {
+				for (User::op_iterator oi = inst->op_begin(), oe = inst->op_end();
+						callable && oi != oe; ++oi)
+					callable = collectNativeGlobals(*oi, globals);
+				continue;
+			}
+
+			CallSite cs(inst);
+			Function *callee = 
+				dyn_cast<Function>(cs.getCalledValue()->stripPointerCasts());
+			if (!callee) {
+				callable = false;
+			} else if (callee->isDeclaration()) {
+				if (!callee->isIntrinsic() && 
+						(specialFunctionHandler->handlers.count(callee) ||
+						 callee->getName().startswith("klee_") ||
+						 nativeHeapFunctions.count(callee->getName())))
+					callable = false;
+			} else if (visited.insert(callee).second) {
+				worklist.push_back(callee);
+			}
+			for (CallSite::arg_iterator ai = cs.arg_begin(), ae = cs.arg_end();
+					callable && ai != ae; ++ai)
+				callable = collectNativeGlobals(*ai, globals);
+		}
+	}
+
+	if (callable)
+		nativeGlobalRefs[f].assign(globals.begin(), globals.end());
+	return nativeCallable[f] = callable;
+}
+
+bool Executor::callNativeFunction(ExecutionState &state,
+		KInstruction *target,
+		Function *function,
+		std::vector< ref<Expr> > &arguments) {
+	if (std::find(NativeFunctions.begin(), NativeFunctions.end(),
+				function->getName().str()) == NativeFunctions.end() ||
+			!isNativeCallable(function))
+		return false;
+
+	// Same argument layout as callExternalFunction.
+	uint64_t *args = (uint64_t*) alloca(2*sizeof(*args) * (arguments.size() + 1));
+	memset(args, 0, 2 * sizeof(*args) * (arguments.size() + 1));
+	unsigned wordIndex = 2;
+	std::vector<uint64_t> roots;
+	for (std::vector<ref<Expr> >::iterator ai = arguments.begin(), 
+			ae = arguments.end(); ai!=ae; ++ai) {
+		ConstantExpr *ce = dyn_cast<ConstantExpr>(*ai);
+		if (!ce)
+			return false;
+		ce->toMemory(&args[wordIndex]);
+		wordIndex += (ce->getWidth()+63)/64;
+		if (ce->getWidth() == Context::get().getPointerWidth())
+			roots.push_back(ce->getZExtValue());
+	}
+
+	std::vector<const GlobalValue*> &globals = nativeGlobalRefs[function];
+	for (std::vector<const GlobalValue*>::iterator it = globals.begin(),
+			ie = globals.end(); it != ie; ++it) {
+		std::map<const GlobalValue*, ref<ConstantExpr> >::iterator ga =
+			globalAddresses.find(*it);
+		if (ga == globalAddresses.end())
+			return false;
+		roots.push_back(ga->second->getZExtValue());
+	}
+
+	// Everything the callee may touch has to be concrete; these are also
+	// the only objects it can write.
+	std::vector<uint64_t> touched;
+	if (!state.addressSpace.collectConcreteReachable(roots, MaxNativeObjects,
+				touched))
+		return false;
+
+	if (!nativeGlobalsBound) {
+		std::map<const GlobalValue*, uint64_t> addresses;
+		for (std::map<const GlobalValue*, ref<ConstantExpr> >::iterator
+				it = globalAddresses.begin(), ie = globalAddresses.end();
+				it != ie; ++it)
+			addresses[it->first] = it->second->getZExtValue();
+		externalDispatcher->bindNativeGlobals(addresses);
+		nativeGlobalsBound = true;
+	}
+
+	// Globals the native code cannot be bound to leave it to the
+	// interpreter.
+	if (!externalDispatcher->canExecuteNatively(function))
+		return false;
+
+	state.addressSpace.copyOutConcretes(ExternalSkipSyncedCopyOut);
+
+	if (!externalDispatcher->executeNativeCall(function, target->inst, args)) {
+		terminateStateOnError(state, "failed native call: " + function->getName(),
+				"external.err");
+		return true;
+	}
+	++stats::nativeCalls;
+
+	if (!state.addressSpace.copyInConcretes(touched)) {
+		terminateStateOnError(state, "native call modified read-only object",
+				"external.err");
+		return true;
+	}
+
+	LLVM_TYPE_Q Type *resultType = target->inst->getType();
+	if (resultType != Type::getVoidTy(getGlobalContext())) {
+		ref<Expr> e = ConstantExpr::fromMemory((void*) args, 
+				getWidthForLLVMType(resultType));
+		bindLocal(target, state, e);
+	}
+
+	if (InvokeInst *ii = dyn_cast<InvokeInst>(target->inst))
+		transferToBasicBlock(ii->getNormalDest(), target->inst->getParent(), state);
+	return true;
+}
+
+void Executor::clearNativeFunctions() {
+	externalDispatcher->clearNativeFunctions();
+	nativeGlobalsBound = false;
+	nativeCallable.clear();
+	nativeGlobalRefs.clear();
+}
+
 /***/
 
 ref<Expr> Executor::replaceReadWithSymbolic(ExecutionState &state, 
@@ -3861,8 +4569,7 @@ void Executor::executeMemoryOperation(ExecutionState &state,
 	}
 	klee_message("%s", info.str().c_str());
 #endif
-	Expr::Width type = (isWrite ? value->getWidth() : 
-			getWidthForLLVMType(target->inst->getType()));
+	Expr::Width type = (isWrite ? value->getWidth() : target->width);
 	//llvm::errs() << "type = " << type << "\n";
 	unsigned bytes = Expr::getMinBytesForWidth(type);
 
@@ -4071,8 +4778,13 @@ void Executor::executeMakeSymbolic(ExecutionState &state,
 	// Create a new object state for the memory object (instead of a copy).
 	if (!replayOut) {
 
+		// --infer-sym-ranges seeds each concolic file with its contents.
+		// A reloaded spilled state follows its spilled input instead.
+		bool seedContents = (UseConcreteData || 
+			(interpreterOpts.InferSymRanges && concolicFileIndex.count(name))) &&
+			!resumingStates.count(&state);
 		std::vector<unsigned char> prevVal;
-		if (UseConcreteData) {
+		if (seedContents) {
 			prevVal = readObjectAtAddress(state,
 					ConstantExpr::create(mo->address,
 						Context::get().getPointerWidth()));
@@ -4083,7 +4795,7 @@ void Executor::executeMakeSymbolic(ExecutionState &state,
 		// or if that fails try adding a unique identifier.
 		unsigned id = 0;
 		std::string uniqueName = name;
-		while (!state.arrayNames.insert(uniqueName).second) {
+		while (!state.arrayNames.getWriteable().insert(uniqueName).second) {
 			uniqueName = name + "_" + llvm::utostr(++id);
 		}
 		const Array *array = new Array(uniqueName, mo->size);
@@ -4098,19 +4810,21 @@ void Executor::executeMakeSymbolic(ExecutionState &state,
 					siie = it->second.end(); siit != siie; ++siit) {
 				SeedInfo &si = *siit;
 
-				if ( UseConcreteData ) {
+				if ( seedContents ) {
 #ifdef XQX_CONCRETE_EXEC
 					klee_xqx_debug("set assignment of %s", uniqueName.c_str());
 #endif
-					si.assignment.bindings[array] = prevVal;
+					si.bind(array, prevVal);
+				}
+				else if (!si.input) {
+					// no test to seed from: the array stays unbound
 				}
 				else {
 					KTestObject *obj = si.getNextInput(mo, NamedSeedMatching);
 
 					if (!obj) {
 						if (ZeroSeedExtension) {
-							std::vector<unsigned char> &values = si.assignment.bindings[array];
-							values = std::vector<unsigned char>(mo->size, '\0');
+							si.bind(array, SeedInfo::SeedBytes(mo->size, '\0'));
 						} else if (!AllowSeedExtension) {
 							terminateStateOnError(state, 
 									"ran out of inputs during seeding",
@@ -4134,13 +4848,13 @@ void Executor::executeMakeSymbolic(ExecutionState &state,
 									"user.err");
 							break;
 						} else {
-							std::vector<unsigned char> &values = si.assignment.bindings[array];
-							values.insert(values.begin(), obj->bytes, 
+							SeedInfo::SeedBytes values(obj->bytes, 
 									obj->bytes + std::min(obj->numBytes, mo->size));
 							if (ZeroSeedExtension) {
 								for (unsigned i=obj->numBytes; i<mo->size; ++i)
 									values.push_back('\0');
 							}
+							si.bind(array, values);
 						}
 					}
 				}
@@ -4259,6 +4973,7 @@ void Executor::runFunctionAsMain(Function *f,
 
 	globalObjects.clear();
 	globalAddresses.clear();
+	clearNativeFunctions();
 
 	if (statsTracker)
 		statsTracker->done();
@@ -4327,8 +5042,8 @@ bool Executor::getSymbolicSolution(const ExecutionState &state,
 
 	ExecutionState tmp(state);
 	if (!NoPreferCex) {
-		for (unsigned i = 0; i != state.symbolics.size(); ++i) {
-			const MemoryObject *mo = state.symbolics[i].first;
+		for (unsigned i = 0; i != state.symbolics->size(); ++i) {
+			const MemoryObject *mo = (*state.symbolics)[i].first;
 			std::vector< ref<Expr> >::const_iterator pi = 
 				mo->cexPreferences.begin(), pie = mo->cexPreferences.end();
 			for (; pi != pie; ++pi) {
@@ -4344,9 +5059,11 @@ bool Executor::getSymbolicSolution(const ExecutionState &state,
 
 	std::vector< std::vector<unsigned char> > values;
 	std::vector<const Array*> objects;
-	for (unsigned i = 0; i != state.symbolics.size(); ++i)
-		objects.push_back(state.symbolics[i].second);
+	for (unsigned i = 0; i != state.symbolics->size(); ++i)
+		objects.push_back((*state.symbolics)[i].second);
 	bool success = solver->getInitialValues(tmp, objects, values);
+	if (success && !state.checksumChecks.empty())
+		fixChecksums(state, objects, values);
 	solver->setTimeout(0);
 	if (!success) {
 		klee_warning("unable to compute initial values (invalid constraints?)!");
@@ -4356,14 +5073,104 @@ bool Executor::getSymbolicSolution(const ExecutionState &state,
 		return false;
 	}
 
-	for (unsigned i = 0; i != state.symbolics.size(); ++i)
-		res.push_back(std::make_pair(state.symbolics[i].first->name, values[i]));
+	for (unsigned i = 0; i != state.symbolics->size(); ++i)
+		res.push_back(std::make_pair((*state.symbolics)[i].first->name, values[i]));
 	return true;
 }
 
+void Executor::fixChecksums(const ExecutionState &state,
+		std::vector<const Array*> &objects,
+		std::vector< std::vector<unsigned char> > &values) {
+	// A fixup may change bytes an earlier checksum is computed from or
+	// stored in, so go over the checks again until none needs fixing.
+	unsigned rounds = state.checksumChecks.size() + 1;
+	bool fixed = true;
+	for (; fixed && rounds; --rounds) {
+		fixed = false;
+		for (std::vector< std::pair< ref<Expr>, ref<Expr> > >::const_iterator
+				it = state.checksumChecks.begin(), ie = state.checksumChecks.end();
+				it != ie; ++it) {
+			Assignment assignment(objects, values, true);
+			ref<Expr> computed = assignment.evaluate(it->first);
+			if (!isa<ConstantExpr>(computed) ||
+					assignment.evaluate(it->second) == computed)
+				continue;
+
+			// Solve again under the path constraints for a stored value equal
+			// to the checksum, keeping the bytes the checksum is computed
+			// from so that it does not move.
+			std::vector< ref<Expr> > assumptions(state.constraints.begin(),
+					state.constraints.end());
+			assumptions.push_back(EqExpr::create(it->second, computed));
+			std::vector< ref<ReadExpr> > reads;
+			findReads(it->first, /*visitUpdates=*/true, reads);
+			for (std::vector< ref<ReadExpr> >::iterator ri = reads.begin(),
+					re = reads.end(); ri != re; ++ri) {
+				const Array *root = (*ri)->updates.root;
+				ConstantExpr *CE = dyn_cast<ConstantExpr>((*ri)->index);
+				std::vector<const Array*>::iterator oi =
+					std::find(objects.begin(), objects.end(), root);
+				if (!CE || oi == objects.end())
+					continue;
+				unsigned index = CE->getZExtValue(32);
+				assumptions.push_back(EqExpr::create(
+							ReadExpr::create(UpdateList(root, 0), CE),
+							ConstantExpr::alloc(values[oi - objects.begin()][index],
+								Expr::Int8)));
+			}
+
+			ExecutionState fixup(assumptions);
+			std::vector< std::vector<unsigned char> > patched;
+			if (!solver->getInitialValues(fixup, objects, patched)) {
+				klee_warning_once(0, "unable to fix up a checksum: the path "
+						"constraints do not allow the stored value to match");
+				continue;
+			}
+			values = patched;
+			fixed = true;
+		}
+	}
+
+	if (fixed)
+		klee_warning_once(0, "checksum fixups did not settle; "
+				"the test may still fail a checksum");
+}
+
 void Executor::getCoveredLines(const ExecutionState &state,
 		std::map<const std::string*, std::set<unsigned> > &res) {
-	res = state.coveredLines;
+	const InstructionBitSet::words_ty &words = state.coveredInstructions->getWords();
+	for (InstructionBitSet::words_ty::const_iterator it = words.begin(),
+			ie = words.end(); it != ie; ++it)
+		for (unsigned bit = 0; bit != 64; ++bit)
+			if (it->second & ((uint64_t) 1 << bit)) {
+				const InstructionInfo &ii = 
+					kmodule->infos->getInfoByID(it->first * 64 + bit);
+				res[&ii.file].insert(ii.line);
+			}
+}
+
+void Executor::recordBranchInputBytes(ExecutionState &state,
+		ref<Expr> condition) {
+	if (!interpreterOpts.InferSymRanges || isa<ConstantExpr>(condition) ||
+			!state.stack.back().kf->isFocusedFunc)
+		return;
+
+	std::vector< ref<ReadExpr> > reads;
+	findReads(condition, /*visitUpdates=*/true, reads);
+
+	std::set< std::pair<const Array*, unsigned> > counted;
+	for (std::vector< ref<ReadExpr> >::iterator it = reads.begin(),
+			ie = reads.end(); it != ie; ++it) {
+		const Array *root = (*it)->updates.root;
+		// Reads at a symbolic index are skipped; the bytes making up the
+		// index are reads of their own.
+		ConstantExpr *CE = dyn_cast<ConstantExpr>((*it)->index);
+		if (!root->isSymbolicArray() || !CE)
+			continue;
+		unsigned offset = CE->getZExtValue(32);
+		if (counted.insert(std::make_pair(root, offset)).second)
+			++branchInputBytes[root->name][offset];
+	}
 }
 
 void Executor::doImpliedValueConcretization(ExecutionState &state,
@@ -4756,6 +5563,7 @@ void Executor::xRunFunction(Function *f)
 
 	globalObjects.clear();
 	globalAddresses.clear();
+	clearNativeFunctions();
 
 	if (statsTracker)
 		statsTracker->done();
@@ -4926,9 +5734,14 @@ bool Executor::setFocusedFuncs(std::set<std::string> focusedFuncs)
 		statsTracker = 
 			new StatsTracker(*this,
 					interpreterHandler->getOutputFilename("assembly.ll"),
-					userSearcherRequiresMD2U());
+					userSearcherRequiresMD2U() || PruneUnreachableStates,
+					userSearcherRequiresFD2U() || PruneUnreachableStates);
 	}
 #endif
+	// The distances to uncovered focused code were computed before the
+	// functions were focused.
+	if (statsTracker && (userSearcherRequiresFD2U() || PruneUnreachableStates))
+		statsTracker->computeReachableUncovered();
 
     return true;
 
@@ -25,6 +25,7 @@
 #include <string>
 #include <map>
 #include <set>
+#include <deque>
 
 struct KTest;
 
@@ -77,6 +78,7 @@ namespace klee {
   /// removedStates, and haltExecution, among others.
 
 class Executor : public Interpreter {
+  friend class AutoMergingSearcher;
   friend class BumpMergingSearcher;
   friend class MergingSearcher;
   friend class RandomPathSearcher;
@@ -104,6 +106,19 @@ public:
 private:
   class TimerInfo;
 
+  /// Where a state was when it was spilled, checked against the state
+  /// re-derived from its input before it resumes.
+  struct SpillPoint {
+    /// The on-disk input of the state.
+    std::string path;
+    /// The number of instructions the state had executed.
+    uint64_t steppedInstructions;
+    /// The id of the instruction it was about to execute.
+    unsigned pcId;
+    /// The depth of its call stack.
+    unsigned stackDepth;
+  };
+
   KModule *kmodule;
   InterpreterHandler *interpreterHandler;
   Searcher *searcher;
@@ -157,6 +172,16 @@ private:
   /// pointers. We use the actual Function* address as the function address.
   std::set<uint64_t> legalFunctions;
 
+  /// Cached results of isNativeCallable(), and the global variables
+  /// referenced by each native callable function and its callees.
+  std::map<const llvm::Function*, bool> nativeCallable;
+  std::map<const llvm::Function*, 
+           std::vector<const llvm::GlobalValue*> > nativeGlobalRefs;
+
+  /// Whether the global addresses of the current run have been bound
+  /// for native calls.
+  bool nativeGlobalsBound;
+
   /// When non-null the bindings that will be used for calls to
   /// klee_make_symbolic in order replay.
   const struct KTest *replayOut;
@@ -170,10 +195,45 @@ private:
   /// drive execution.
   const std::vector<struct KTest *> *usingSeeds;  
 
+  /// When non-null, the basic blocks entered are set in it by the id of
+  /// their first instruction. \see setBlockCoverage()
+  std::vector<bool> *blockCoverage;
+
+  /// The statistics tracker, set aside while blocks are recorded so
+  /// those replays do not count as covering anything.
+  StatsTracker *suspendedStatsTracker;
+
+  /// The concolic input files, and the index of each by path. These are
+  /// handed to the runtime through klee_get_concolic_file().
+  std::vector<ConcolicFile> concolicFiles;
+  std::map<std::string, unsigned> concolicFileIndex;
+
+  /// When inferring symbolic ranges, how many branch conditions in
+  /// focused functions each symbolic byte has reached, by array name
+  /// and byte offset. \see recordBranchInputBytes()
+  std::map<std::string, std::map<unsigned, unsigned> > branchInputBytes;
+
   /// Disables forking, instead a random path is chosen. Enabled as
   /// needed to control memory usage. \see fork()
   bool atMemoryLimit;
 
+  /// When state spilling is enabled, an untouched copy of the initial
+  /// state from which spilled states are re-derived. \see spillState()
+  ExecutionState *spillRoot;
+
+  /// The spilled states, in spill order.
+  std::deque<SpillPoint> spilledStates;
+
+  /// Reloaded states which are still replaying their spilled input,
+  /// mapped to the point at which they resume exploring.
+  std::map<ExecutionState*, SpillPoint> resumingStates;
+
+  /// Inputs loaded for reloaded states, owned until the run ends.
+  std::vector<struct KTest *> reloadedInputs;
+
+  /// Number of spill files written, used to name them.
+  unsigned spillCount;
+
   /// Disables forking, set by client. \see setInhibitForking()
   bool inhibitForking;
 
@@ -213,12 +273,38 @@ private:
   void transferToBasicBlock(llvm::BasicBlock *dst, 
 			    llvm::BasicBlock *src,
 			    ExecutionState &state);
+  /// Like transferToBasicBlock, with the destination given by its
+  /// pre-resolved entry index (see KInstruction::successors).
+  void transferToBlockEntry(unsigned entry, llvm::BasicBlock *src,
+			    ExecutionState &state);
+
+  /// Mark the block starting at \a ki in blockCoverage.
+  void recordBlockEntry(KInstruction *ki);
 
   void callExternalFunction(ExecutionState &state,
                             KInstruction *target,
                             llvm::Function *function,
                             std::vector< ref<Expr> > &arguments);
 
+  /// Whether function and its callees can be run natively, i.e. they
+  /// only call defined functions and externals, do not take the address
+  /// of functions, and do not allocate or free heap memory. Pointers
+  /// returned by native code must point into objects the state knows.
+  bool isNativeCallable(llvm::Function *function);
+
+  /// Run a call to a function named by --native-functions natively
+  /// through the JIT, if the arguments and all memory reachable from
+  /// them and from the globals it uses are concrete.
+  ///
+  /// \return true if the call was handled.
+  bool callNativeFunction(ExecutionState &state,
+                          KInstruction *target,
+                          llvm::Function *function,
+                          std::vector< ref<Expr> > &arguments);
+
+  /// Drop the native code and bindings of the current run.
+  void clearNativeFunctions();
+
   ObjectState *bindObjectInState(ExecutionState &state, const MemoryObject *mo,
                                  bool isLocal, const Array *array = 0);
 
@@ -297,6 +383,33 @@ private:
   // current state, and one of the states may be null.
   StatePair fork(ExecutionState &current, ref<Expr> condition, bool isInternal);
 
+  /// Credit the symbolic bytes read by a branch condition in
+  /// branchInputBytes, if ranges are being inferred and the branch
+  /// lies in a focused function.
+  void recordBranchInputBytes(ExecutionState &state, ref<Expr> condition);
+
+  /// Patch the solution \a values for \a objects so that the stored
+  /// side of each of the state's bypassed checksum comparisons equals the
+  /// checksum computed from the solution. Each patch is solved under the
+  /// state's constraints, and the checks are repeated until all hold.
+  void fixChecksums(const ExecutionState &state,
+                    std::vector<const Array*> &objects,
+                    std::vector< std::vector<unsigned char> > &values);
+
+  /// Fork a seeded state without querying the solver when all of its
+  /// seeds agree on the direction of condition. The current state
+  /// follows the seeds, the other side is created with its condition
+  /// pending (see \ref resolveSpeculativeState). Returns false if the
+  /// seeds do not decide the branch.
+  bool speculativeFork(ExecutionState &current, ref<Expr> condition,
+                       bool isInternal, StatePair &result);
+
+  /// Check the pending condition of a speculatively forked state and
+  /// add it as a constraint. Returns false if the condition is
+  /// infeasible, in which case the state has been terminated without
+  /// generating a test case.
+  bool resolveSpeculativeState(ExecutionState &state);
+
   /// Add the given (boolean) condition as a constraint on state. This
   /// function is a wrapper around the state's addConstraint function
   /// which also manages propagation of implied values,
@@ -313,12 +426,12 @@ private:
   Cell& getArgumentCell(ExecutionState &state,
                         KFunction *kf,
                         unsigned index) {
-    return state.stack.back().locals[kf->getArgRegister(index)];
+    return state.stack.back().locals.getWriteable()[kf->getArgRegister(index)];
   }
 
   Cell& getDestCell(ExecutionState &state,
                     KInstruction *target) {
-    return state.stack.back().locals[target->dest];
+    return state.stack.back().locals.getWriteable()[target->dest];
   }
 
   void bindLocal(KInstruction *target, 
@@ -359,6 +472,29 @@ private:
 
   // remove state from queue and delete
   void terminateState(ExecutionState &state);
+  /// Write an input reaching \a state to the spill store and remove
+  /// the state. Returns false, leaving the state alone, if no input
+  /// could be computed or written.
+  bool spillState(ExecutionState &state);
+
+  /// Re-derive up to \a count spilled states by replaying their inputs
+  /// from \ref spillRoot with forking disabled.
+  void reloadSpilledStates(unsigned count);
+
+  /// Let a reloaded state fork again once it has replayed as far as
+  /// the state it was spilled from. Returns false, terminating the
+  /// state, if the replay did not end up where that state was.
+  bool checkSpillResumePoint(ExecutionState &state);
+
+  /// Kill or spill states to get back under the memory cap.
+  void shedStates(unsigned mbs);
+
+  /// Terminate the states which have no static path left to an
+  /// uncovered instruction of a focused function, of which there are
+  /// \a numFocusedUncovered. Called by the StatsTracker whenever it
+  /// updates the distances.
+  void pruneUnreachableStates(unsigned numFocusedUncovered);
+
   // call exit handler and terminate state
   void terminateStateEarly(ExecutionState &state, const llvm::Twine &message);
   // call exit handler and terminate state
@@ -448,9 +584,18 @@ public:
     replayPosition = 0;
   }
 
+  virtual void setConcolicFiles(const std::vector<ConcolicFile> &files) {
+    concolicFiles = files;
+    concolicFileIndex.clear();
+    for (unsigned i = 0; i != files.size(); ++i)
+      concolicFileIndex[files[i].path] = i;
+  }
+
   virtual const llvm::Module *
   setModule(llvm::Module *module, const ModuleOptions &opts);
 
+  virtual void setBlockCoverage(std::vector<bool> *blocks);
+
   virtual void useSeeds(const std::vector<struct KTest *> *seeds) { 
     usingSeeds = seeds;
   }
@@ -489,6 +634,11 @@ public:
   virtual void getCoveredLines(const ExecutionState &state,
                                std::map<const std::string*, std::set<unsigned> > &res);
 
+  virtual void getBranchInputBytes(
+      std::map<std::string, std::map<unsigned, unsigned> > &res) {
+    res = branchInputBytes;
+  }
+
   Expr::Width getWidthForLLVMType(LLVM_TYPE_Q llvm::Type *type) const;
 
   virtual void printStatsInfoWithSrcLine();
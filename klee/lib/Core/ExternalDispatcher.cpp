@@ -34,15 +34,18 @@
 #include "llvm/ExecutionEngine/GenericValue.h"
 #include "llvm/Support/CallSite.h"
 #include "llvm/Support/DynamicLibrary.h"
+#include "llvm/Support/InstIterator.h"
 #include "llvm/Support/raw_ostream.h"
 #if LLVM_VERSION_CODE < LLVM_VERSION(3, 0)
 #include "llvm/Target/TargetSelect.h"
 #else
 #include "llvm/Support/TargetSelect.h"
 #endif
+#include "llvm/Transforms/Utils/Cloning.h"
 #include <setjmp.h>
 #include <signal.h>
 #include <iostream>
+#include <set>
 
 using namespace llvm;
 using namespace klee;
@@ -156,6 +159,182 @@ bool ExternalDispatcher::executeCall(Function *f, Instruction *i, uint64_t *args
   return runProtectedCall(dispatcher, args);
 }
 
+bool ExternalDispatcher::executeNativeCall(Function *f, Instruction *i,
+                                           uint64_t *args) {
+  std::pair<const Instruction*, const Function*> key(i, f);
+  native_dispatchers_ty::iterator it = nativeDispatchers.find(key);
+  Function *dispatcher;
+
+  if (it == nativeDispatchers.end()) {
+    Function *native = getNativeFunction(f);
+    dispatcher = native ? createDispatcher(f, i, native) : 0;
+    nativeDispatchers.insert(std::make_pair(key, dispatcher));
+    if (dispatcher)
+      executionEngine->recompileAndRelinkFunction(dispatcher);
+  } else {
+    dispatcher = it->second;
+  }
+
+  return runProtectedCall(dispatcher, args);
+}
+
+void ExternalDispatcher::bindNativeGlobals(const std::map<const GlobalValue*,
+                                                          uint64_t> &addresses) {
+  for (std::map<const GlobalValue*, uint64_t>::const_iterator
+         it = addresses.begin(), ie = addresses.end(); it != ie; ++it) {
+    LLVM_TYPE_Q Type *type =
+      cast<PointerType>(it->first->getType())->getElementType();
+    // Native code never refers to functions other than through calls.
+    if (type->isFunctionTy() || nativeGlobals.count(it->first))
+      continue;
+
+    GlobalVariable *gv = new GlobalVariable(*dispatchModule, type, false,
+                                            GlobalValue::ExternalLinkage, 0,
+                                            it->first->getName());
+    executionEngine->addGlobalMapping(gv, (void*) (unsigned long) it->second);
+    nativeGlobals[it->first] = gv;
+    nativeVariables.push_back(gv);
+  }
+}
+
+void ExternalDispatcher::clearNativeFunctions() {
+  for (native_dispatchers_ty::iterator it = nativeDispatchers.begin(),
+         ie = nativeDispatchers.end(); it != ie; ++it) {
+    if (Function *dispatcher = it->second) {
+      executionEngine->freeMachineCodeForFunction(dispatcher);
+      dispatcher->eraseFromParent();
+    }
+  }
+  nativeDispatchers.clear();
+
+  // The clones may call each other, so drop all bodies before erasing.
+  for (std::vector<Function*>::iterator it = nativeClones.begin(),
+         ie = nativeClones.end(); it != ie; ++it) {
+    executionEngine->freeMachineCodeForFunction(*it);
+    (*it)->dropAllReferences();
+  }
+  for (std::vector<Function*>::iterator it = nativeClones.begin(),
+         ie = nativeClones.end(); it != ie; ++it)
+    (*it)->eraseFromParent();
+  for (std::vector<GlobalVariable*>::iterator it = nativeVariables.begin(),
+         ie = nativeVariables.end(); it != ie; ++it) {
+    executionEngine->updateGlobalMapping(*it, 0);
+    (*it)->eraseFromParent();
+  }
+
+  nativeClones.clear();
+  nativeVariables.clear();
+  nativeGlobals.clear();
+  nonNativeFunctions.clear();
+}
+
+static void collectGlobals(Value *v, std::set<GlobalValue*> &globals) {
+  if (GlobalValue *gv = dyn_cast<GlobalValue>(v)) {
+    globals.insert(gv);
+  } else if (Constant *c = dyn_cast<Constant>(v)) {
+    for (User::op_iterator it = c->op_begin(), ie = c->op_end(); it != ie; ++it)
+      collectGlobals(*it, globals);
+  }
+}
+
+Function *ExternalDispatcher::createNativeClone(Function *f) {
+  Function *clone = Function::Create(f->getFunctionType(),
+                                     GlobalValue::InternalLinkage,
+                                     f->getName(), dispatchModule);
+  clone->copyAttributesFrom(f);
+  nativeGlobals[f] = clone;
+  nativeClones.push_back(clone);
+  return clone;
+}
+
+bool ExternalDispatcher::canExecuteNatively(Function *f) {
+  return getNativeFunction(f) != 0;
+}
+
+Function *ExternalDispatcher::getNativeFunction(Function *f) {
+  std::map<const GlobalValue*, Constant*>::iterator it = nativeGlobals.find(f);
+  if (it != nativeGlobals.end())
+    return cast<Function>(it->second);
+  if (nonNativeFunctions.count(f))
+    return 0;
+
+  // First find everything the bodies refer to, so that nothing is
+  // cloned if some global cannot be given to native code. Variables
+  // have been bound already; anything else that is not a function,
+  // such as an alias, is left to the interpreter.
+  std::vector<Function*> sources, declarations;
+  std::set<Function*> seen;
+  sources.push_back(f);
+  seen.insert(f);
+  for (unsigned n = 0; n != sources.size(); ++n) {
+    std::set<GlobalValue*> globals;
+    for (inst_iterator i = inst_begin(sources[n]), ie = inst_end(sources[n]);
+         i != ie; ++i)
+      for (User::op_iterator oi = i->op_begin(), oe = i->op_end();
+           oi != oe; ++oi)
+        collectGlobals(*oi, globals);
+
+    for (std::set<GlobalValue*>::iterator it = globals.begin(),
+           ie = globals.end(); it != ie; ++it) {
+      if (nativeGlobals.count(*it))
+        continue;
+      Function *callee = dyn_cast<Function>(*it);
+      if (!callee) {
+        nonNativeFunctions.insert(f);
+        return 0;
+      }
+      if (!seen.insert(callee).second)
+        continue;
+      if (callee->isDeclaration())
+        declarations.push_back(callee);
+      else
+        sources.push_back(callee);
+    }
+  }
+
+  // Then map them: defined functions to new clones and external
+  // functions to declarations, resolved by the JIT like any external
+  // call.
+  Function *result = 0;
+  for (std::vector<Function*>::iterator it = sources.begin(),
+         ie = sources.end(); it != ie; ++it) {
+    Function *clone = createNativeClone(*it);
+    if (!result)
+      result = clone;
+  }
+  for (std::vector<Function*>::iterator it = declarations.begin(),
+         ie = declarations.end(); it != ie; ++it) {
+    Function *callee = *it;
+    nativeGlobals[callee] =
+      dispatchModule->getOrInsertFunction(callee->getName(),
+                                          callee->getFunctionType(),
+                                          callee->getAttributes());
+  }
+
+  for (std::vector<Function*>::iterator it = sources.begin(),
+         ie = sources.end(); it != ie; ++it) {
+    Function *source = *it;
+    Function *clone = cast<Function>(nativeGlobals[source]);
+
+    ValueToValueMapTy vmap;
+    for (std::map<const GlobalValue*, Constant*>::iterator
+           git = nativeGlobals.begin(), gie = nativeGlobals.end();
+         git != gie; ++git)
+      vmap[git->first] = git->second;
+    Function::arg_iterator cai = clone->arg_begin();
+    for (Function::arg_iterator ai = source->arg_begin(),
+           ae = source->arg_end(); ai != ae; ++ai, ++cai) {
+      cai->setName(ai->getName());
+      vmap[ai] = cai;
+    }
+
+    SmallVector<ReturnInst*, 8> returns;
+    CloneFunctionInto(clone, source, vmap, true, returns);
+  }
+
+  return result;
+}
+
 // FIXME: This is not reentrant.
 static uint64_t *gTheArgsP;
 
@@ -192,8 +371,9 @@ bool ExternalDispatcher::runProtectedCall(Function *f, uint64_t *args) {
 // the special cases that the JIT knows how to directly call. If this is not
 // done, then the jit will end up generating a nullary stub just to call our
 // stub, for every single function call.
-Function *ExternalDispatcher::createDispatcher(Function *target, Instruction *inst) {
-  if (!resolveSymbol(target->getName()))
+Function *ExternalDispatcher::createDispatcher(Function *target, Instruction *inst,
+                                              Function *native) {
+  if (!native && !resolveSymbol(target->getName()))
     return 0;
 
   CallSite cs;
@@ -251,7 +431,7 @@ Function *ExternalDispatcher::createDispatcher(Function *target, Instruction *in
     idx += ((!!argSize ? argSize : 64) + 63)/64;
   }
 
-  Constant *dispatchTarget =
+  Constant *dispatchTarget = native ? native :
     dispatchModule->getOrInsertFunction(target->getName(), FTy,
                                         target->getAttributes());
 #if LLVM_VERSION_CODE >= LLVM_VERSION(3, 0)
@@ -11,14 +11,19 @@
 #define KLEE_EXTERNALDISPATCHER_H
 
 #include <map>
+#include <set>
 #include <string>
+#include <vector>
 #include <stdint.h>
 
 namespace llvm {
+  class Constant;
   class ExecutionEngine;
   class Instruction;
   class Function;
   class FunctionType;
+  class GlobalValue;
+  class GlobalVariable;
   class Module;
 }
 
@@ -31,7 +36,24 @@ namespace klee {
     llvm::ExecutionEngine *executionEngine;
     std::map<std::string, void*> preboundFunctions;
     
-    llvm::Function *createDispatcher(llvm::Function *f, llvm::Instruction *i);
+    /// Dispatchers for native calls, keyed by call site and callee.
+    typedef std::map<std::pair<const llvm::Instruction*, const llvm::Function*>,
+                     llvm::Function*> native_dispatchers_ty;
+    native_dispatchers_ty nativeDispatchers;
+    /// What module globals are mapped to in dispatchModule for native
+    /// calls: clones of defined functions, declarations of external
+    /// functions and declarations of variables bound to their address.
+    std::map<const llvm::GlobalValue*, llvm::Constant*> nativeGlobals;
+    std::vector<llvm::Function*> nativeClones;
+    std::vector<llvm::GlobalVariable*> nativeVariables;
+    /// Functions which refer to globals that cannot be bound for native
+    /// code, such as aliases or variables without an address.
+    std::set<const llvm::Function*> nonNativeFunctions;
+
+    llvm::Function *createDispatcher(llvm::Function *f, llvm::Instruction *i,
+                                     llvm::Function *native = 0);
+    llvm::Function *createNativeClone(llvm::Function *f);
+    llvm::Function *getNativeFunction(llvm::Function *f);
     bool runProtectedCall(llvm::Function *f, uint64_t *args);
     
   public:
@@ -43,6 +65,26 @@ namespace klee {
      * into args[0].
      */
     bool executeCall(llvm::Function *function, llvm::Instruction *i, uint64_t *args);
+
+    /* Bind the global variables of the module being executed to the
+     * given addresses for code run by executeNativeCall().
+     */
+    void bindNativeGlobals(const std::map<const llvm::GlobalValue*, uint64_t> &addresses);
+
+    /* Like executeCall(), but for a function defined in the module being
+     * executed: the function and the functions it calls are cloned into
+     * the JIT and run natively.
+     */
+    bool executeNativeCall(llvm::Function *function, llvm::Instruction *i,
+                           uint64_t *args);
+
+    /* Return true if the function can be run by executeNativeCall(),
+     * i.e. every global its code refers to is bound or callable.
+     */
+    bool canExecuteNatively(llvm::Function *function);
+
+    /* Drop the native clones and the global bindings. */
+    void clearNativeFunctions();
     void *resolveSymbol(const std::string &name);
   };  
 }
@@ -69,6 +69,7 @@ ObjectHolder &ObjectHolder::operator=(const ObjectHolder &b) {
 /***/
 
 int MemoryObject::counter = 0;
+uint64_t ObjectState::nextStoreVersion = 0;
 
 MemoryObject::~MemoryObject() {
 	if (parent)
@@ -104,6 +105,7 @@ ObjectState::ObjectState(const MemoryObject *mo)
 	refCount(0),
 	object(mo),
 	concreteStore(new uint8_t[mo->size]),
+	storeVersion(++nextStoreVersion),
 	concreteMask(0),
 	flushMask(0),
 	knownSymbolics(0),
@@ -126,6 +128,7 @@ ObjectState::ObjectState(const MemoryObject *mo, const Array *array)
 	refCount(0),
 	object(mo),
 	concreteStore(new uint8_t[mo->size]),
+	storeVersion(++nextStoreVersion),
 	concreteMask(0),
 	flushMask(0),
 	knownSymbolics(0),
@@ -142,6 +145,7 @@ ObjectState::ObjectState(const ObjectState &os)
 	refCount(0),
 	object(os.object),
 	concreteStore(new uint8_t[os.size]),
+	storeVersion(++nextStoreVersion),
 	concreteMask(os.concreteMask ? new BitArray(*os.concreteMask, os.size) : 0),
 	flushMask(os.flushMask ? new BitArray(*os.flushMask, os.size) : 0),
 	knownSymbolics(0),
@@ -196,11 +200,8 @@ const UpdateList &ObjectState::getUpdates() const {
 			Writes[i] = std::make_pair(un->index, un->value);
 		}
 
-		std::vector< ref<ConstantExpr> > Contents(size);
-
 		// Initialize to zeros.
-		for (unsigned i = 0, e = size; i != e; ++i)
-			Contents[i] = ConstantExpr::create(0, Expr::Int8);
+		std::vector<uint8_t> Contents(size, 0);
 
 		// Pull off as many concrete writes as we can.
 		unsigned Begin = 0, End = Writes.size();
@@ -214,7 +215,7 @@ const UpdateList &ObjectState::getUpdates() const {
 			if (!Value)
 				break;
 
-			Contents[Index->getZExtValue()] = Value;
+			Contents[Index->getZExtValue()] = Value->getZExtValue(8);
 		}
 
 		// FIXME: We should unique these, there is no good reason to create multiple
@@ -224,8 +225,8 @@ const UpdateList &ObjectState::getUpdates() const {
 		// FIXME: Leaked.
 		static unsigned id = 0;
 		const Array *array = new Array("const_arr" + llvm::utostr(++id), size,
-				&Contents[0],
-				&Contents[0] + Contents.size());
+				new ArrayContents(&Contents[0],
+					&Contents[0] + Contents.size()));
 		updates = UpdateList(array, 0);
 
 		// Apply the remaining (non-constant) writes.
@@ -260,6 +261,7 @@ void ObjectState::makeSymbolic() {
 void ObjectState::initializeToZero() {
 	makeConcrete();
 	memset(concreteStore, 0, size);
+	markStoreModified();
 }
 
 void ObjectState::initializeToRandom() {  
@@ -268,6 +270,7 @@ void ObjectState::initializeToRandom() {
 		// randomly selected by 256 sided die
 		concreteStore[i] = 0xAB;
 	}
+	markStoreModified();
 }
 
 /*
@@ -420,6 +423,7 @@ ref<Expr> ObjectState::read8(ref<Expr> offset) const {
 void ObjectState::write8(unsigned offset, uint8_t value) {
 	//assert(read_only == false && "writing to read-only object!");
 	concreteStore[offset] = value;
+	markStoreModified();
 	setKnownSymbolic(offset, 0);
 
 	markByteConcrete(offset);
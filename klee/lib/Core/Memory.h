@@ -66,6 +66,11 @@ public:
   /// should sensibly be only at creation time).
   mutable std::vector< ref<Expr> > cexPreferences;
 
+  /// The ObjectState::storeVersion of the concrete bytes last copied
+  /// between this object and its host memory, or 0 if unknown. Used to
+  /// skip objects that have not changed around external calls.
+  mutable uint64_t hostStoreVersion;
+
   // DO NOT IMPLEMENT
   MemoryObject(const MemoryObject &b);
   MemoryObject &operator=(const MemoryObject &b);
@@ -80,7 +85,8 @@ public:
       size(0),
       isFixed(true),
       parent(NULL),
-      allocSite(0) {
+      allocSite(0),
+      hostStoreVersion(0) {
   }
 
   MemoryObject(uint64_t _address, unsigned _size, 
@@ -98,7 +104,8 @@ public:
       fake_object(false),
       isUserSpecified(false),
       parent(_parent), 
-      allocSite(_allocSite) {
+      allocSite(_allocSite),
+      hostStoreVersion(0) {
   }
 
   ~MemoryObject();
@@ -166,6 +173,12 @@ private:
   const MemoryObject *object;
 
   uint8_t *concreteStore;
+
+  /// storeVersion - A globally unique stamp for the current contents of
+  /// concreteStore, renewed on every change to it.
+  uint64_t storeVersion;
+  static uint64_t nextStoreVersion;
+
   // XXX cleanup name of flushMask (its backwards or something)
   BitArray *concreteMask;
 
@@ -220,6 +233,8 @@ public:
 private:
   const UpdateList &getUpdates() const;
 
+  void markStoreModified() { storeVersion = ++nextStoreVersion; }
+
   void makeConcrete();
 
   void makeSymbolic();
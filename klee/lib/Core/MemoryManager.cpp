@@ -19,52 +19,214 @@
 
 #include "llvm/Support/CommandLine.h"
 
+#include <sys/mman.h>
+
+using namespace llvm;
 using namespace klee;
 
+namespace {
+  cl::opt<bool>
+  DeterministicAllocation("allocate-determ",
+                          cl::desc("Allocate program memory from an arena "
+                                   "reserved at a fixed address, so that "
+                                   "addresses are the same across runs "
+                                   "(default=off)"),
+                          cl::init(false));
+
+  cl::opt<unsigned>
+  DeterministicAllocationSize("allocate-determ-size",
+                              cl::desc("Size of the arena reserved by "
+                                       "--allocate-determ, in MB "
+                                       "(default=100)"),
+                              cl::init(100));
+
+  cl::opt<unsigned long long>
+  DeterministicStartAddress("allocate-determ-start-address",
+                            cl::desc("Start address of the arena reserved "
+                                     "by --allocate-determ "
+                                     "(default=0x7ff30000000)"),
+                            cl::init(0x7ff30000000ULL));
+}
+
 /***/
 
+// Blocks up to MaxSizeClass bytes are rounded up to a power of two, no
+// smaller than MinSizeClass; larger blocks are rounded up to whole pages.
+static const uint64_t MinSizeClass = 16;
+static const uint64_t MaxSizeClass = 1024 * 1024;
+static const uint64_t LargeBlockAlign = 4096;
+
+static unsigned getSizeClass(uint64_t size) {
+  unsigned index = 0;
+  for (uint64_t blockSize = MinSizeClass; blockSize < size; blockSize <<= 1)
+    ++index;
+  return index;
+}
+
+static uint64_t getBlockSize(uint64_t size) {
+  if (size > MaxSizeClass)
+    return (size + LargeBlockAlign - 1) & ~(LargeBlockAlign - 1);
+  return MinSizeClass << getSizeClass(size);
+}
+
+MemoryManager::MemoryManager()
+  : deterministicSpace(0), spaceSize(0), nextFreeSlot(0),
+    liveBytes(0), peakBytes(0) {
+  if (!DeterministicAllocation)
+    return;
+
+  spaceSize = (uint64_t) DeterministicAllocationSize * 1024 * 1024;
+  void *hint = (void *) (unsigned long) DeterministicStartAddress;
+  void *space = mmap(hint, spaceSize, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (space == MAP_FAILED) {
+    klee_warning("Could not reserve %u MB for deterministic allocation, "
+                 "falling back to malloc.",
+                 (unsigned) DeterministicAllocationSize);
+    spaceSize = 0;
+    return;
+  }
+  if (space != hint)
+    klee_warning("Deterministic allocation arena was placed at %p instead "
+                 "of %p; addresses will not be reproducible.", space, hint);
+
+  deterministicSpace = (char *) space;
+  sizeClassFreeLists.resize(getSizeClass(MaxSizeClass) + 1);
+}
+
 MemoryManager::~MemoryManager() { 
   while (!objects.empty()) {
     MemoryObject *mo = *objects.begin();
-    if (!mo->isFixed)
+    if (!mo->isFixed && !isInArena(mo->address))
       free((void *)mo->address);
     objects.erase(mo);
     delete mo;
   }
+
+  if (deterministicSpace)
+    munmap(deterministicSpace, spaceSize);
+}
+
+bool MemoryManager::isInArena(uint64_t address) const {
+  uint64_t base = (uint64_t) (unsigned long) deterministicSpace;
+  return deterministicSpace && address >= base && address < base + spaceSize;
 }
 
+uint64_t MemoryManager::allocateInArena(uint64_t size) {
+  uint64_t blockSize = getBlockSize(size);
+  uint64_t base = (uint64_t) (unsigned long) deterministicSpace;
+
+  if (blockSize <= MaxSizeClass) {
+    std::vector<uint64_t> &freeList = sizeClassFreeLists[getSizeClass(size)];
+    if (!freeList.empty()) {
+      uint64_t address = freeList.back();
+      freeList.pop_back();
+      return address;
+    }
+  } else {
+    // Best fit; the tail of a larger block goes back on the list.
+    std::multimap<uint64_t, uint64_t>::iterator it =
+      largeFreeBlocks.lower_bound(blockSize);
+    if (it != largeFreeBlocks.end()) {
+      uint64_t address = it->second, available = it->first;
+      largeFreeBlocks.erase(it);
+      if (available > blockSize)
+        largeFreeBlocks.insert(std::make_pair(available - blockSize,
+                                              address + blockSize));
+      return address;
+    }
+  }
+
+  if (spaceSize - nextFreeSlot < blockSize)
+    return 0;
+  uint64_t address = base + nextFreeSlot;
+  nextFreeSlot += blockSize;
+  return address;
+}
+
+void MemoryManager::freeInArena(uint64_t address, uint64_t size) {
+  uint64_t blockSize = getBlockSize(size);
+  if (blockSize <= MaxSizeClass)
+    sizeClassFreeLists[getSizeClass(size)].push_back(address);
+  else
+    largeFreeBlocks.insert(std::make_pair(blockSize, address));
+}
+
+#ifndef NDEBUG
+void MemoryManager::insertRange(uint64_t address, uint64_t size) {
+  if (size)
+    ranges.insert(std::make_pair(address, size));
+}
+
+void MemoryManager::eraseRange(uint64_t address, uint64_t size) {
+  ranges_ty::iterator it = ranges.find(address);
+  if (it != ranges.end() && it->second == size)
+    ranges.erase(it);
+}
+
+bool MemoryManager::overlapsRange(uint64_t address, uint64_t size) const {
+  if (!size)
+    return false;
+  // The first range starting at or after address overlaps iff it starts
+  // before our end; the last range starting before address overlaps iff
+  // it ends after our start.
+  ranges_ty::const_iterator it = ranges.lower_bound(address);
+  if (it != ranges.end() && it->first < address + size)
+    return true;
+  if (it != ranges.begin()) {
+    --it;
+    if (it->first + it->second > address)
+      return true;
+  }
+  return false;
+}
+#endif
+
 MemoryObject *MemoryManager::allocate(uint64_t size, bool isLocal, 
                                       bool isGlobal,
                                       const llvm::Value *allocSite) {
   if (size>10*1024*1024)
     klee_warning_once(0, "Large alloc: %u bytes.  KLEE may run out of memory.", (unsigned) size);
   
-  uint64_t address = (uint64_t) (unsigned long) malloc((unsigned) size);
+  uint64_t address = 0;
+  if (deterministicSpace) {
+    address = allocateInArena(size);
+    if (!address)
+      klee_warning_once(0, "Deterministic allocation arena exhausted, "
+                        "falling back to malloc.");
+  }
+  if (!address)
+    address = (uint64_t) (unsigned long) malloc((unsigned) size);
   if (!address)
     return 0;
   
   ++stats::allocations;
+  liveBytes += size;
+  if (liveBytes > peakBytes)
+    peakBytes = liveBytes;
   MemoryObject *res = new MemoryObject(address, size, isLocal, isGlobal, false,
                                        allocSite, this);
   objects.insert(res);
+#ifndef NDEBUG
+  insertRange(address, size);
+#endif
   return res;
 }
 
 MemoryObject *MemoryManager::allocateFixed(uint64_t address, uint64_t size,
                                            const llvm::Value *allocSite) {
 #ifndef NDEBUG
-  for (objects_ty::iterator it = objects.begin(), ie = objects.end();
-       it != ie; ++it) {
-    MemoryObject *mo = *it;
-    if (address+size > mo->address && address < mo->address+mo->size)
-      klee_error("Trying to allocate an overlapping object");
-  }
+  if (overlapsRange(address, size))
+    klee_error("Trying to allocate an overlapping object");
 #endif
 
   ++stats::allocations;
   MemoryObject *res = new MemoryObject(address, size, false, true, true,
                                        allocSite, this);
   objects.insert(res);
+#ifndef NDEBUG
+  insertRange(address, size);
+#endif
   return res;
 }
 
@@ -75,8 +237,16 @@ void MemoryManager::deallocate(const MemoryObject *mo) {
 void MemoryManager::markFreed(MemoryObject *mo) {
   if (objects.find(mo) != objects.end())
   {
-    if (!mo->isFixed)
-      free((void *)mo->address);
+    if (!mo->isFixed) {
+      if (isInArena(mo->address))
+        freeInArena(mo->address, mo->size);
+      else
+        free((void *)mo->address);
+      liveBytes -= mo->size;
+    }
+#ifndef NDEBUG
+    eraseRange(mo->address, mo->size);
+#endif
     objects.erase(mo);
   }
 }
@@ -10,7 +10,9 @@
 #ifndef KLEE_MEMORYMANAGER_H
 #define KLEE_MEMORYMANAGER_H
 
+#include <map>
 #include <set>
+#include <vector>
 #include <stdint.h>
 
 namespace llvm {
@@ -25,8 +27,42 @@ namespace klee {
     typedef std::set<MemoryObject*> objects_ty;
     objects_ty objects;
 
+#ifndef NDEBUG
+    /// Address ranges of all live, non-empty objects, keyed by start
+    /// address, used to check fixed objects for overlap. The ranges are
+    /// disjoint, so overlap with a new range only has to be checked
+    /// against its two neighbours.
+    typedef std::map<uint64_t, uint64_t> ranges_ty;
+    ranges_ty ranges;
+#endif
+
+    /// The arena reserved for program memory when --allocate-determ is
+    /// set, or null. Allocation bumps nextFreeSlot; freed blocks are
+    /// kept on per-size-class free lists (LIFO, so that the addresses
+    /// handed out only depend on the allocation sequence).
+    char *deterministicSpace;
+    uint64_t spaceSize;
+    uint64_t nextFreeSlot;
+    std::vector< std::vector<uint64_t> > sizeClassFreeLists;
+    /// Free blocks larger than the biggest size class, size -> address.
+    std::multimap<uint64_t, uint64_t> largeFreeBlocks;
+
+    /// Bytes currently allocated for the program, and the high-water mark.
+    uint64_t liveBytes;
+    uint64_t peakBytes;
+
+    bool isInArena(uint64_t address) const;
+    uint64_t allocateInArena(uint64_t size);
+    void freeInArena(uint64_t address, uint64_t size);
+
+#ifndef NDEBUG
+    void insertRange(uint64_t address, uint64_t size);
+    void eraseRange(uint64_t address, uint64_t size);
+    bool overlapsRange(uint64_t address, uint64_t size) const;
+#endif
+
   public:
-    MemoryManager() {}
+    MemoryManager();
     ~MemoryManager();
 
     MemoryObject *allocate(uint64_t size, bool isLocal, bool isGlobal,
@@ -35,6 +71,13 @@ namespace klee {
                                 const llvm::Value *allocSite);
     void deallocate(const MemoryObject *mo);
     void markFreed(MemoryObject *mo);
+
+    /// getLiveBytes - The number of bytes of program memory currently
+    /// allocated through allocate().
+    uint64_t getLiveBytes() const { return liveBytes; }
+
+    /// getPeakBytes - The largest value getLiveBytes() has reached.
+    uint64_t getPeakBytes() const { return peakBytes; }
   };
 
 } // End klee namespace
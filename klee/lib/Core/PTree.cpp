@@ -52,11 +52,26 @@ void PTree::remove(Node *n) {
         assert(n == p->right);
         p->right = 0;
       }
+    } else {
+      root = 0;
     }
     n = p;
   } while (n && !n->left && !n->right);
 }
 
+PTreeNode *PTree::graft(const data_type &data) {
+  if (!root) {
+    root = new Node(0, data);
+    return root;
+  }
+  Node *top = new Node(0, 0);
+  top->left = root;
+  root->parent = top;
+  top->right = new Node(top, data);
+  root = top;
+  return top->right;
+}
+
 void PTree::dump(std::ostream &os, bool dumpCond) {
   ExprPPrinter *pp = ExprPPrinter::create(os);
   pp->setNewline("\\l");
@@ -35,6 +35,10 @@ namespace klee {
 								 ref<Expr> cond=NULL);
     void remove(Node *n);
 
+    /// graft - Add a leaf for a state which does not descend from any
+    /// state in the tree, placing it beside the current root.
+    Node *graft(const data_type &data);
+
     void dump(std::ostream &os, bool dumpCond=false);
   };
 
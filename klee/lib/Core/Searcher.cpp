@@ -34,6 +34,11 @@
 #include "llvm/Instructions.h"
 #include "llvm/Module.h"
 #endif
+#if LLVM_VERSION_CODE >= LLVM_VERSION(3, 5)
+#include "llvm/IR/Dominators.h"
+#else
+#include "llvm/Analysis/Dominators.h"
+#endif
 #include "llvm/Support/CallSite.h"
 #include "llvm/Support/CFG.h"
 #include "llvm/Support/CommandLine.h"
@@ -171,6 +176,7 @@ WeightedRandomSearcher::WeightedRandomSearcher(Executor &_executor,
   case CPInstCount:
   case QueryCost:
   case MinDistToUncovered:
+  case MinDistToFocused:
   case CoveringNew:
     updateWeights = true;
     break;
@@ -222,6 +228,12 @@ double WeightedRandomSearcher::getWeight(ExecutionState *es) {
       return invMD2U * invMD2U;
     }
   }
+  case MinDistToFocused: {
+    uint64_t fd2u = computeMinDistToFocusedUncovered(es->pc,
+                                                     es->stack.back().minDistToFocusedOnReturn);
+    double invFD2U = 1. / (fd2u ? fd2u : 10000);
+    return invFD2U * invFD2U;
+  }
   }
 }
 
@@ -495,6 +507,143 @@ void MergingSearcher::update(ExecutionState *current,
 
 ///
 
+AutoMergingSearcher::AutoMergingSearcher(Executor &_executor,
+                                         Searcher *_baseSearcher,
+                                         unsigned _maxHeld,
+                                         unsigned _maxCost)
+  : executor(_executor),
+    baseSearcher(_baseSearcher),
+    maxHeld(_maxHeld),
+    maxCost(_maxCost) {
+}
+
+AutoMergingSearcher::~AutoMergingSearcher() {
+  delete baseSearcher;
+}
+
+///
+
+const std::set<Instruction*> &
+AutoMergingSearcher::getJoinPoints(KFunction *kf) {
+  std::map<const KFunction*, std::set<Instruction*> >::iterator it = 
+    joinPoints.find(kf);
+  if (it != joinPoints.end())
+    return it->second;
+
+  std::set<Instruction*> &points = joinPoints[kf];
+  DominatorTreeBase<BasicBlock> pdt(true);
+  pdt.recalculate(*kf->function);
+  for (Function::iterator bbit = kf->function->begin(), 
+         bbie = kf->function->end(); bbit != bbie; ++bbit) {
+    TerminatorInst *ti = bbit->getTerminator();
+    if (!ti || ti->getNumSuccessors() < 2)
+      continue;
+    DomTreeNode *node = pdt.getNode(bbit);
+    if (!node || !node->getIDom())
+      continue;
+    // The virtual exit node of a function with several returns has no
+    // block.
+    if (BasicBlock *join = node->getIDom()->getBlock())
+      points.insert(join->getFirstNonPHI());
+  }
+  return points;
+}
+
+bool AutoMergingSearcher::isAtJoinPoint(ExecutionState &es) {
+  Instruction *i = es.pc->inst;
+
+  std::map<ExecutionState*, Instruction*>::iterator it = released.find(&es);
+  if (it != released.end()) {
+    if (it->second == i)
+      return false;
+    released.erase(it);
+  }
+
+  // A state with an unresolved speculative condition is left to run so
+  // the executor resolves it first; it is held once that is done.
+  if (!es.speculativeCondition.isNull())
+    return false;
+
+  KFunction *kf = es.stack.back().kf;
+  if (!kf->isFocusedFunc)
+    return false;
+  return getJoinPoints(kf).count(i) != 0;
+}
+
+void AutoMergingSearcher::mergeHeldStates() {
+  std::map<Instruction*, std::vector<ExecutionState*> > merges;
+  for (std::set<ExecutionState*>::const_iterator it = statesAtMerge.begin(),
+         ie = statesAtMerge.end(); it != ie; ++it)
+    merges[(*it)->pc->inst].push_back(*it);
+
+  for (std::map<Instruction*, std::vector<ExecutionState*> >::iterator
+         it = merges.begin(), ie = merges.end(); it != ie; ++it) {
+    std::vector<ExecutionState*> &toMerge = it->second;
+    std::vector<bool> merged(toMerge.size(), false);
+
+    for (unsigned i = 0; i != toMerge.size(); ++i) {
+      if (merged[i])
+        continue;
+      ExecutionState *base = toMerge[i];
+      for (unsigned j = i + 1; j != toMerge.size(); ++j) {
+        if (!merged[j] && base->merge(*toMerge[j], maxCost)) {
+          merged[j] = true;
+          ++stats::autoMerges;
+          if (DebugLogMerge)
+            std::cerr << "\tauto-merged: " << base << " with " 
+                      << toMerge[j] << "\n";
+          // The merged state stays in statesAtMerge until the executor
+          // reports it removed.
+          executor.terminateState(*toMerge[j]);
+        }
+      }
+
+      statesAtMerge.erase(base);
+      released[base] = it->first;
+      baseSearcher->addState(base);
+    }
+  }
+}
+
+ExecutionState &AutoMergingSearcher::selectState() {
+  while (!baseSearcher->empty()) {
+    ExecutionState &es = baseSearcher->selectState();
+    if (!isAtJoinPoint(es))
+      return es;
+
+    baseSearcher->removeState(&es, &es);
+    statesAtMerge.insert(&es);
+    if (statesAtMerge.size() >= maxHeld)
+      break;
+  }
+
+  mergeHeldStates();
+  return selectState();
+}
+
+void AutoMergingSearcher::update(ExecutionState *current,
+                                 const std::set<ExecutionState*> &addedStates,
+                                 const std::set<ExecutionState*> &removedStates) {
+  if (!removedStates.empty()) {
+    std::set<ExecutionState *> alt = removedStates;
+    for (std::set<ExecutionState*>::const_iterator it = removedStates.begin(),
+           ie = removedStates.end(); it != ie; ++it) {
+      ExecutionState *es = *it;
+      released.erase(es);
+      std::set<ExecutionState*>::iterator it2 = statesAtMerge.find(es);
+      if (it2 != statesAtMerge.end()) {
+        statesAtMerge.erase(it2);
+        alt.erase(es);
+      }
+    }    
+    baseSearcher->update(current, addedStates, alt);
+  } else {
+    baseSearcher->update(current, addedStates, removedStates);
+  }
+}
+
+///
+
 BatchingSearcher::BatchingSearcher(Searcher *_baseSearcher,
                                    double _timeBudget,
                                    unsigned _instructionBudget) 
@@ -28,6 +28,7 @@ namespace klee {
   template<class T> class DiscretePDF;
   class ExecutionState;
   class Executor;
+  struct KFunction;
 
   class Searcher {
   public:
@@ -79,6 +80,7 @@ namespace klee {
       RandomPath,
       NURS_CovNew,
       NURS_MD2U,
+      NURS_FD2U,
       NURS_Depth,
       NURS_ICnt,
       NURS_CPICnt,
@@ -137,6 +139,7 @@ namespace klee {
       InstCount,
       CPInstCount,
       MinDistToUncovered,
+      MinDistToFocused,
       CoveringNew
     };
 
@@ -165,6 +168,7 @@ namespace klee {
       case InstCount          : os << "InstCount\n"; return;
       case CPInstCount        : os << "CPInstCount\n"; return;
       case MinDistToUncovered : os << "MinDistToUncovered\n"; return;
+      case MinDistToFocused   : os << "MinDistToFocused\n"; return;
       case CoveringNew        : os << "CoveringNew\n"; return;
       default                 : os << "<unknown type>\n"; return;
       }
@@ -234,6 +238,45 @@ namespace klee {
     }
   };
 
+  /// AutoMergingSearcher - Merges states without klee_merge() calls at
+  /// the join points of focused functions, i.e. the immediate
+  /// post-dominators of their conditional branches.
+  ///
+  /// A state reaching a join point is held back until the base searcher
+  /// runs out of states or \a maxHeld states are held. Held states at
+  /// the same join point with the same stack are then merged, unless a
+  /// merge would cost more than \a maxCost select expressions.
+  class AutoMergingSearcher : public Searcher {
+    Executor &executor;
+    std::set<ExecutionState*> statesAtMerge;
+    /// States released from a join point, which are not held again
+    /// until they have moved past it.
+    std::map<ExecutionState*, llvm::Instruction*> released;
+    std::map<const KFunction*, std::set<llvm::Instruction*> > joinPoints;
+    Searcher *baseSearcher;
+    unsigned maxHeld;
+    unsigned maxCost;
+
+  private:
+    const std::set<llvm::Instruction*> &getJoinPoints(KFunction *kf);
+    bool isAtJoinPoint(ExecutionState &es);
+    void mergeHeldStates();
+
+  public:
+    AutoMergingSearcher(Executor &executor, Searcher *baseSearcher,
+                        unsigned maxHeld, unsigned maxCost);
+    ~AutoMergingSearcher();
+
+    ExecutionState &selectState();
+    void update(ExecutionState *current,
+                const std::set<ExecutionState*> &addedStates,
+                const std::set<ExecutionState*> &removedStates);
+    bool empty() { return baseSearcher->empty() && statesAtMerge.empty(); }
+    void printName(std::ostream &os) {
+      os << "AutoMergingSearcher\n";
+    }
+  };
+
   class BatchingSearcher : public Searcher {
     Searcher *baseSearcher;
     double timeBudget;
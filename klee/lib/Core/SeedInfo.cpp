@@ -15,11 +15,64 @@
 
 #include "klee/ExecutionState.h"
 #include "klee/Expr.h"
+#include "klee/util/ExprEvaluator.h"
 #include "klee/util/ExprUtil.h"
 #include "klee/Internal/ADT/KTest.h"
 
 using namespace klee;
 
+namespace {
+  class SeedEvaluator : public ExprEvaluator {
+    const SeedInfo &seed;
+
+  protected:
+    ref<Expr> getInitialValue(const Array &array, unsigned index) {
+      return seed.evaluate(&array, index);
+    }
+
+  public:
+    SeedEvaluator(const SeedInfo &_seed) : seed(_seed) {}
+  };
+}
+
+unsigned char SeedInfo::getByte(const Array *array, unsigned index) const {
+  if (!patches.empty()) {
+    patches_ty::const_iterator it = patches.find(std::make_pair(array, index));
+    if (it != patches.end())
+      return it->second;
+  }
+  bindings_ty::const_iterator it = bindings.find(array);
+  if (it != bindings.end() && index < it->second->size())
+    return (*it->second)[index];
+  return 0;
+}
+
+ref<Expr> SeedInfo::evaluate(const Array *array, unsigned index) const {
+  // bytes past the end of a short seed are left free, as are unbound ones
+  bindings_ty::const_iterator it = bindings.find(array);
+  if (it == bindings.end() ||
+      (index >= it->second->size() &&
+       !patches.count(std::make_pair(array, index))))
+    return ReadExpr::create(UpdateList(array, 0),
+                            ConstantExpr::alloc(index, Expr::Int32));
+  return ConstantExpr::alloc(getByte(array, index), Expr::Int8);
+}
+
+ref<Expr> SeedInfo::evaluate(ref<Expr> e) const {
+  SeedEvaluator v(*this);
+  return v.visit(e);
+}
+
+bool SeedInfo::satisfies(const ConstraintManager &constraints) const {
+  for (ConstraintManager::constraint_iterator it = constraints.begin(),
+         ie = constraints.end(); it != ie; ++it) {
+    ConstantExpr *CE = dyn_cast<ConstantExpr>(evaluate(*it));
+    if (!CE || !CE->isTrue())
+      return false;
+  }
+  return true;
+}
+
 KTestObject *SeedInfo::getNextInput(const MemoryObject *mo,
                                    bool byName) {
   if (byName) {
@@ -91,10 +144,9 @@ void SeedInfo::patchSeed(const ExecutionState &state,
                                       ConstantExpr::alloc(i, Expr::Int32));
     
     // If not in bindings then this can't be a violation?
-    Assignment::bindings_ty::iterator it2 = assignment.bindings.find(array);
-    if (it2 != assignment.bindings.end()) {
+    if (bindings.count(array)) {
       ref<Expr> isSeed = EqExpr::create(read, 
-                                        ConstantExpr::alloc(it2->second[i], 
+                                        ConstantExpr::alloc(getByte(array, i), 
                                                             Expr::Int8));
       bool res;
       bool success = solver->mustBeFalse(tmp, isSeed, res);
@@ -105,10 +157,8 @@ void SeedInfo::patchSeed(const ExecutionState &state,
         bool success = solver->getValue(tmp, read, value);
         assert(success && "FIXME: Unhandled solver failure");            
         (void) success;
-        it2->second[i] = value->getZExtValue(8);
-        tmp.addConstraint(EqExpr::create(read, 
-                                         ConstantExpr::alloc(it2->second[i], 
-                                                             Expr::Int8)));
+        patches[std::make_pair(array, i)] = value->getZExtValue(8);
+        tmp.addConstraint(EqExpr::create(read, value));
       } else {
         tmp.addConstraint(isSeed);
       }
@@ -116,7 +166,7 @@ void SeedInfo::patchSeed(const ExecutionState &state,
   }
 
   bool res;
-  bool success = solver->mayBeTrue(state, assignment.evaluate(condition), res);
+  bool success = solver->mayBeTrue(state, evaluate(condition), res);
   assert(success && "FIXME: Unhandled solver failure");
   (void) success;
   if (res)
@@ -124,14 +174,14 @@ void SeedInfo::patchSeed(const ExecutionState &state,
   
   // We could still do a lot better than this, for example by looking at
   // independence. But really, this shouldn't be happening often.
-  for (Assignment::bindings_ty::iterator it = assignment.bindings.begin(), 
-         ie = assignment.bindings.end(); it != ie; ++it) {
+  for (bindings_ty::iterator it = bindings.begin(), 
+         ie = bindings.end(); it != ie; ++it) {
     const Array *array = it->first;
     for (unsigned i=0; i<array->size; ++i) {
       ref<Expr> read = ReadExpr::create(UpdateList(array, 0),
                                         ConstantExpr::alloc(i, Expr::Int32));
       ref<Expr> isSeed = EqExpr::create(read, 
-                                        ConstantExpr::alloc(it->second[i], 
+                                        ConstantExpr::alloc(getByte(array, i), 
                                                             Expr::Int8));
       bool res;
       bool success = solver->mustBeFalse(tmp, isSeed, res);
@@ -142,10 +192,8 @@ void SeedInfo::patchSeed(const ExecutionState &state,
         bool success = solver->getValue(tmp, read, value);
         assert(success && "FIXME: Unhandled solver failure");            
         (void) success;
-        it->second[i] = value->getZExtValue(8);
-        tmp.addConstraint(EqExpr::create(read, 
-                                         ConstantExpr::alloc(it->second[i], 
-                                                             Expr::Int8)));
+        patches[std::make_pair(array, i)] = value->getZExtValue(8);
+        tmp.addConstraint(EqExpr::create(read, value));
       } else {
         tmp.addConstraint(isSeed);
       }
@@ -156,7 +204,7 @@ void SeedInfo::patchSeed(const ExecutionState &state,
   {
     bool res;
     bool success = 
-      solver->mayBeTrue(state, assignment.evaluate(condition), res);
+      solver->mayBeTrue(state, evaluate(condition), res);
     assert(success && "FIXME: Unhandled solver failure");            
     (void) success;
     assert(res && "seed patching failed");
@@ -172,13 +220,13 @@ void SeedInfo::printSeedInfo()
 	klee_xqx_debug("=============printseedinfo============");
 
 	
-  for (Assignment::bindings_ty::iterator it = assignment.bindings.begin(), 
-         ie = assignment.bindings.end(); it != ie; ++it) {
+  for (bindings_ty::iterator it = bindings.begin(), 
+         ie = bindings.end(); it != ie; ++it) {
     const Array *array = it->first;
 	klee_xqx_debug("assign-name = %s", array->name.c_str());
 	klee_xqx_debug("assign-size = %d", array->size);
     for (unsigned i=0; i<array->size; ++i) {
-		ref<Expr> tmp = assignment.evaluate(array, i);
+		ref<Expr> tmp = evaluate(array, i);
 		tmp->dump();
 
 	}
@@ -10,7 +10,12 @@
 #ifndef KLEE_SEEDINFO_H
 #define KLEE_SEEDINFO_H
 
-#include "klee/util/Assignment.h"
+#include "klee/Expr.h"
+#include "klee/Internal/ADT/CopyOnWrite.h"
+
+#include <map>
+#include <set>
+#include <vector>
 
 extern "C" {
   struct KTest;
@@ -18,24 +23,53 @@ extern "C" {
 }
 
 namespace klee {
+  class ConstraintManager;
   class ExecutionState;
+  class MemoryObject;
   class TimingSolver;
 
   class SeedInfo {
   public:
-    Assignment assignment;
+    typedef std::vector<unsigned char> SeedBytes;
+    /// The seed values of each symbolic array. The bytes are stored once
+    /// and shared by every state following the seed, so copying a
+    /// SeedInfo on a fork only copies the handles.
+    typedef std::map<const Array*, CopyOnWrite<SeedBytes> > bindings_ty;
+    /// Bytes changed by patchSeed(), which override the shared values
+    /// in this copy of the seed only.
+    typedef std::map<std::pair<const Array*, unsigned>, unsigned char>
+      patches_ty;
+
+    bindings_ty bindings;
+    patches_ty patches;
     KTest *input;
     unsigned inputPosition;
     std::set<struct KTestObject*> used;
     
   public:
     explicit
-    SeedInfo(KTest *_input) : assignment(true),
-                             input(_input),
+    SeedInfo(KTest *_input) : input(_input),
                              inputPosition(0) {}
     
     KTestObject *getNextInput(const MemoryObject *mo,
                              bool byName);
+
+    /// Bind the seed values of a new symbolic array.
+    void bind(const Array *array, const SeedBytes &values) {
+      bindings[array] = CopyOnWrite<SeedBytes>(values);
+    }
+
+    /// Return the seed value of a byte, or a read of it if the seed does
+    /// not bind its array or is too short to hold it.
+    ref<Expr> evaluate(const Array *array, unsigned index) const;
+
+    /// Evaluate an expression under the seed values.
+    ref<Expr> evaluate(ref<Expr> e) const;
+
+    /// Whether the seed values satisfy every constraint. A constraint
+    /// on bytes the seed leaves free cannot be decided without the
+    /// solver and counts as unsatisfied.
+    bool satisfies(const ConstraintManager &constraints) const;
     
     /// Patch the seed so that condition is satisfied while retaining as
     /// many of the seed values as possible.
@@ -43,6 +77,9 @@ namespace klee {
                    ref<Expr> condition,
                    TimingSolver *solver);
 	void printSeedInfo();
+
+  private:
+    unsigned char getByte(const Array *array, unsigned index) const;
   };
 }
 
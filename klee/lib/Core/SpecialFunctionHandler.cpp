@@ -28,6 +28,7 @@
 #endif
 #include "llvm/ADT/Twine.h"
 
+#include <algorithm>
 #include <errno.h>
 #include <sstream>
 #include <string>
@@ -75,6 +76,7 @@ HandlerInfo handlerInfo[] = {
   add("free", handleFree, false),
   add("klee_assume", handleAssume, false),
   add("klee_check_memory_access", handleCheckMemoryAccess, false),
+  add("klee_checksum_match", handleChecksumMatch, true),
   add("klee_get_valuef", handleGetValue, true),
   add("klee_get_valued", handleGetValue, true),
   add("klee_get_valuel", handleGetValue, true),
@@ -82,6 +84,7 @@ HandlerInfo handlerInfo[] = {
   add("klee_get_value_i32", handleGetValue, true),
   add("klee_get_value_i64", handleGetValue, true),
   add("klee_define_fixed_object", handleDefineFixedObject, false),
+  add("klee_get_concolic_file", handleGetConcolicFile, true),
   add("klee_get_obj_size", handleGetObjSize, true),
   add("klee_get_errno", handleGetErrno, true),
   add("klee_is_symbolic", handleIsSymbolic, true),
@@ -91,6 +94,7 @@ HandlerInfo handlerInfo[] = {
   add("klee_prefer_cex", handlePreferCex, false),
   add("klee_print_expr", handlePrintExpr, false),
   add("klee_print_range", handlePrintRange, false),
+  add("klee_read_file_bytes", handleReadFileBytes, true),
   add("klee_set_forking", handleSetForking, false),
   add("klee_stack_trace", handleStackTrace, false),
   add("klee_warning", handleWarning, false),
@@ -229,6 +233,24 @@ SpecialFunctionHandler::readStringAtAddress(ExecutionState &state,
   return result;
 }
 
+void SpecialFunctionHandler::writeWordsAtAddress(ExecutionState &state,
+                                                 ref<Expr> addressExpr,
+                                                 const std::vector<unsigned> &words) {
+  ObjectPair op;
+  addressExpr = executor.toUnique(state, addressExpr);
+  ref<ConstantExpr> address = cast<ConstantExpr>(addressExpr);
+  if (!state.addressSpace.resolveOne(address, op))
+    assert(0 && "XXX out of bounds / multiple resolution unhandled");
+  const MemoryObject *mo = op.first;
+  uint64_t offset = address->getZExtValue() - mo->address;
+  assert(offset + words.size() * 4 <= mo->size &&
+         "XXX out of bounds write unhandled");
+
+  ObjectState *wos = state.addressSpace.getWriteable(mo, op.second);
+  for (unsigned i = 0; i != words.size(); ++i)
+    wos->write(offset + i * 4, ConstantExpr::create(words[i], Expr::Int32));
+}
+
 /****/
 
 void SpecialFunctionHandler::handleAbort(ExecutionState &state,
@@ -463,6 +485,22 @@ void SpecialFunctionHandler::handleAssume(ExecutionState &state,
   }
 }
 
+void SpecialFunctionHandler::handleChecksumMatch(ExecutionState &state,
+                                                 KInstruction *target,
+                                                 std::vector<ref<Expr> > &arguments) {
+  assert(arguments.size()==2 &&
+         "invalid number of arguments to klee_checksum_match");
+
+  ref<Expr> match = EqExpr::create(arguments[0], arguments[1]);
+  // A symbolic comparison is taken to hold; the stored checksum is made
+  // to agree with the computed one when a test is generated.
+  if (!isa<ConstantExpr>(match)) {
+    state.checksumChecks.push_back(std::make_pair(arguments[0], arguments[1]));
+    match = ConstantExpr::alloc(1, Expr::Bool);
+  }
+  executor.bindLocal(target, state, ZExtExpr::create(match, Expr::Int32));
+}
+
 void SpecialFunctionHandler::handleIsSymbolic(ExecutionState &state,
                                 KInstruction *target,
                                 std::vector<ref<Expr> > &arguments) {
@@ -590,6 +628,57 @@ void SpecialFunctionHandler::handleGetObjSize(ExecutionState &state,
   }
 }
 
+void SpecialFunctionHandler::handleGetConcolicFile(ExecutionState &state,
+                                                   KInstruction *target,
+                                                   std::vector<ref<Expr> > &arguments) {
+  assert(arguments.size()==4 &&
+         "invalid number of arguments to klee_get_concolic_file");
+
+  ref<Expr> path = executor.toUnique(state, arguments[0]);
+  ref<Expr> maxRanges = executor.toUnique(state, arguments[2]);
+  ref<Expr> numRanges = executor.toUnique(state, arguments[3]);
+  if (!isa<ConstantExpr>(path) || !isa<ConstantExpr>(maxRanges) ||
+      !isa<ConstantExpr>(numRanges)) {
+    executor.terminateStateOnError(state, 
+                                   "klee_get_concolic_file requires constant args",
+                                   "user.err");
+    return;
+  }
+
+  if (cast<ConstantExpr>(path)->isZero()) {
+    executor.bindLocal(target, state,
+                       ConstantExpr::create(executor.concolicFiles.size(),
+                                            Expr::Int32));
+    return;
+  }
+
+  std::map<std::string, unsigned>::iterator it = 
+    executor.concolicFileIndex.find(readStringAtAddress(state, path));
+  if (it == executor.concolicFileIndex.end()) {
+    executor.bindLocal(target, state, ConstantExpr::create(-1, Expr::Int32));
+    return;
+  }
+
+  const std::vector<Interpreter::ConcolicRange> &ranges = 
+    executor.concolicFiles[it->second].ranges;
+  unsigned n = std::min((uint64_t) ranges.size(),
+                        cast<ConstantExpr>(maxRanges)->getZExtValue());
+  if (n) {
+    std::vector<unsigned> words;
+    for (unsigned i = 0; i != n; ++i) {
+      words.push_back(ranges[i].offset);
+      words.push_back(ranges[i].length);
+      words.push_back(ranges[i].fillMethod);
+    }
+    writeWordsAtAddress(state, arguments[1], words);
+  }
+  if (!cast<ConstantExpr>(numRanges)->isZero())
+    writeWordsAtAddress(state, numRanges, 
+                        std::vector<unsigned>(1, ranges.size()));
+
+  executor.bindLocal(target, state, ConstantExpr::create(it->second, Expr::Int32));
+}
+
 void SpecialFunctionHandler::handleGetErrno(ExecutionState &state,
                                             KInstruction *target,
                                             std::vector<ref<Expr> > &arguments) {
@@ -702,6 +791,72 @@ void SpecialFunctionHandler::handleCheckMemoryAccess(ExecutionState &state,
   }
 }
 
+void SpecialFunctionHandler::handleReadFileBytes(ExecutionState &state,
+                                                 KInstruction *target,
+                                                 std::vector<ref<Expr> > &arguments) {
+  assert(arguments.size()==5 &&
+         "invalid number of arguments to klee_read_file_bytes");
+
+  ref<Expr> dest = executor.toUnique(state, arguments[0]);
+  ref<Expr> contents = executor.toUnique(state, arguments[1]);
+  ref<Expr> size = executor.toUnique(state, arguments[2]);
+  ref<Expr> offset = executor.toUnique(state, arguments[3]);
+  ref<Expr> count = executor.toUnique(state, arguments[4]);
+  if (!isa<ConstantExpr>(dest) || !isa<ConstantExpr>(contents) ||
+      !isa<ConstantExpr>(size) || !isa<ConstantExpr>(offset) ||
+      !isa<ConstantExpr>(count)) {
+    executor.terminateStateOnError(state, 
+                                   "klee_read_file_bytes requires constant args",
+                                   "user.err");
+    return;
+  }
+
+  // Clip the read at the end of the file.
+  uint64_t fileSize = cast<ConstantExpr>(size)->getZExtValue();
+  uint64_t off = cast<ConstantExpr>(offset)->getZExtValue();
+  uint64_t n = cast<ConstantExpr>(count)->getZExtValue();
+  if (off >= fileSize)
+    n = 0;
+  else
+    n = std::min(n, fileSize - off);
+
+  if (n) {
+    ObjectPair src, dst;
+    ref<ConstantExpr> srcAddress = 
+      ConstantExpr::create(cast<ConstantExpr>(contents)->getZExtValue() + off,
+                           Context::get().getPointerWidth());
+    if (!state.addressSpace.resolveOne(srcAddress, src) ||
+        !src.first->getBoundsCheckPointer(srcAddress, n)->isTrue()) {
+      executor.terminateStateOnError(state,
+                                     "klee_read_file_bytes: memory error",
+                                     "ptr.err",
+                                     executor.getAddressInfo(state, srcAddress));
+      return;
+    }
+    if (!state.addressSpace.resolveOne(cast<ConstantExpr>(dest), dst) ||
+        !dst.first->getBoundsCheckPointer(dest, n)->isTrue() ||
+        dst.second->readOnly) {
+      executor.terminateStateOnError(state,
+                                     "klee_read_file_bytes: memory error",
+                                     "ptr.err",
+                                     executor.getAddressInfo(state, dest));
+      return;
+    }
+
+    uint64_t srcOffset = srcAddress->getZExtValue() - src.first->address;
+    uint64_t dstOffset = cast<ConstantExpr>(dest)->getZExtValue() - 
+      dst.first->address;
+    ObjectState *wos = state.addressSpace.getWriteable(dst.first, dst.second);
+    // getWriteable may have replaced the object state we resolved.
+    const ObjectState *ros = src.first == dst.first ? wos : src.second;
+    for (uint64_t i = 0; i != n; ++i)
+      wos->write(dstOffset + i, ros->read8(srcOffset + i));
+  }
+
+  executor.bindLocal(target, state,
+                     ConstantExpr::create(n, Context::get().getPointerWidth()));
+}
+
 void SpecialFunctionHandler::handleGetValue(ExecutionState &state,
                                             KInstruction *target,
                                             std::vector<ref<Expr> > &arguments) {
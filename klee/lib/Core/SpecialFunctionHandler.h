@@ -58,6 +58,11 @@ namespace klee {
     /* Convenience routines */
 
     std::string readStringAtAddress(ExecutionState &state, ref<Expr> address);
+
+    /// Write the given 32-bit words to consecutive locations starting at
+    /// a concrete address.
+    void writeWordsAtAddress(ExecutionState &state, ref<Expr> address,
+                             const std::vector<unsigned> &words);
     
     /* Handlers */
 
@@ -70,12 +75,14 @@ namespace klee {
     HANDLER(handleAssume);
     HANDLER(handleCalloc);
     HANDLER(handleCheckMemoryAccess);
+    HANDLER(handleChecksumMatch);
     HANDLER(handleDefineFixedObject);
     HANDLER(handleDelete);    
     HANDLER(handleDeleteArray);
     HANDLER(handleExit);
     HANDLER(handleAliasFunction);
     HANDLER(handleFree);
+    HANDLER(handleGetConcolicFile);
     HANDLER(handleGetErrno);
     HANDLER(handleGetObjSize);
     HANDLER(handleGetValue);
@@ -90,6 +97,7 @@ namespace klee {
     HANDLER(handlePrintExpr);
     HANDLER(handlePrintRange);
     HANDLER(handleRange);
+    HANDLER(handleReadFileBytes);
     HANDLER(handleRealloc);
     HANDLER(handleReportError);
     HANDLER(handleRevirtObjects);
@@ -211,7 +211,8 @@ static bool instructionIsCoverable(Instruction *i) {
 }
 
 StatsTracker::StatsTracker(Executor &_executor, std::string _objectFilename,
-                           bool _updateMinDistToUncovered)
+                           bool _updateMinDistToUncovered,
+                           bool _updateMinDistToFocused)
   : executor(_executor),
     objectFilename(_objectFilename),
     statsFile(0),
@@ -225,7 +226,8 @@ StatsTracker::StatsTracker(Executor &_executor, std::string _objectFilename,
     fullBranches(0),
     partialBranches(0),
     lastFID(0),
-    updateMinDistToUncovered(_updateMinDistToUncovered) {
+    updateMinDistToUncovered(_updateMinDistToUncovered),
+    updateMinDistToFocused(_updateMinDistToFocused) {
   KModule *km = executor.kmodule;
 
   sys::Path module(objectFilename);
@@ -446,7 +448,7 @@ void StatsTracker::stepInstruction(ExecutionState &es) {
         // FIXME: This trick no longer works, we should fix this in the line
         // number propogation.
         if( ii.line != -1) { 
-          es.coveredLines[&ii.file].insert(ii.line);
+          es.coveredInstructions.getWriteable().insert(ii.id);
           es.coveredNew = true;
           es.instsSinceCovNew = 1;
         }
@@ -491,6 +493,15 @@ void StatsTracker::framePushed(ExecutionState &es, StackFrame *parentFrame) {
       sf.minDistToUncoveredOnReturn = sf.caller ?
         computeMinDistToUncovered(sf.caller, minDistAtRA) : 0;
     }
+
+    if (updateMinDistToFocused) {
+      uint64_t minDistAtRA = 0;
+      if (parentFrame)
+        minDistAtRA = parentFrame->minDistToFocusedOnReturn;
+
+      sf.minDistToFocusedOnReturn = sf.caller ?
+        computeMinDistToFocusedUncovered(sf.caller, minDistAtRA) : 0;
+    }
   }
 }
 
@@ -545,6 +556,8 @@ void StatsTracker::writeStatsHeader() {
              << "'CexCacheTime',"
              << "'ForkTime',"
              << "'ResolveTime',"
+             << "'ProgramBytes',"
+             << "'PeakProgramBytes',"
 #ifdef DEBUG
 	     << "'ArrayHashTime',"
 #endif
@@ -674,6 +687,8 @@ void StatsTracker::writeStatsLine() {
              << "," << stats::cexCacheTime / 1000000.
              << "," << stats::forkTime / 1000000.
              << "," << stats::resolveTime / 1000000.
+             << "," << executor.memory->getLiveBytes()
+             << "," << executor.memory->getPeakBytes()
 #ifdef DEBUG
              << "," << stats::arrayHashTime / 1000000.
 #endif
@@ -1061,16 +1076,14 @@ static std::vector<Instruction*> getSuccs(Instruction *i) {
   return res;
 }
 
-uint64_t klee::computeMinDistToUncovered(const KInstruction *ki,
-                                         uint64_t minDistAtRA) {
-	//klee_xqx_debug("=====computeMinDistToUncovered=======");
+static uint64_t computeMinDist(const Statistic &minDist,
+                               const KInstruction *ki,
+                               uint64_t minDistAtRA) {
   StatisticManager &sm = *theStatisticManager;
   if (minDistAtRA==0) { // unreachable on return, best is local
-    return sm.getIndexedValue(stats::minDistToUncovered,
-                              ki->info->id);
+    return sm.getIndexedValue(minDist, ki->info->id);
   } else {
-    uint64_t minDistLocal = sm.getIndexedValue(stats::minDistToUncovered,
-                                               ki->info->id);
+    uint64_t minDistLocal = sm.getIndexedValue(minDist, ki->info->id);
     uint64_t distToReturn = sm.getIndexedValue(stats::minDistToReturn,
                                                ki->info->id);
 
@@ -1084,6 +1097,84 @@ uint64_t klee::computeMinDistToUncovered(const KInstruction *ki,
   }
 }
 
+uint64_t klee::computeMinDistToUncovered(const KInstruction *ki,
+                                         uint64_t minDistAtRA) {
+  return computeMinDist(stats::minDistToUncovered, ki, minDistAtRA);
+}
+
+uint64_t klee::computeMinDistToFocusedUncovered(const KInstruction *ki,
+                                                uint64_t minDistAtRA) {
+  return computeMinDist(stats::minDistToFocusedUncovered, ki, minDistAtRA);
+}
+
+/// Relax the indexed distances \a minDist, seeded with the distance
+/// of each instruction to itself, along successors and into callees
+/// until they reach a fixpoint.
+void StatsTracker::propagateMinDist(const Statistic &minDist,
+                                    const std::vector<Instruction*> &instructions) {
+  const InstructionInfoTable &infos = *executor.kmodule->infos;
+  StatisticManager &sm = *theStatisticManager;
+
+  // I'm so lazy it's not even worklisted.
+  bool changed;
+  do {
+    changed = false;
+    for (std::vector<Instruction*>::const_iterator it = instructions.begin(),
+           ie = instructions.end(); it != ie; ++it) {
+      Instruction *inst = *it;
+      uint64_t best, cur = best = sm.getIndexedValue(minDist, 
+                                                     infos.getInfo(inst).id);
+      unsigned bestThrough = 0;
+      
+      if (isa<CallInst>(inst) || isa<InvokeInst>(inst)) {
+        std::vector<Function*> &targets = callTargets[inst];
+        for (std::vector<Function*>::iterator fnIt = targets.begin(),
+               ie = targets.end(); fnIt != ie; ++fnIt) {
+          uint64_t dist = functionShortestPath[*fnIt];
+          if (dist) {
+            dist = 1+dist; // count instruction itself
+            if (bestThrough==0 || dist<bestThrough)
+              bestThrough = dist;
+          }
+
+          if (!(*fnIt)->isDeclaration()) {
+            uint64_t calleeDist = sm.getIndexedValue(minDist,
+                                                     infos.getFunctionInfo(*fnIt).id);
+            if (calleeDist) {
+              calleeDist = 1+calleeDist; // count instruction itself
+              if (best==0 || calleeDist<best)
+                best = calleeDist;
+            }
+          }
+        }
+      } else {
+        bestThrough = 1;
+      }
+      
+      if (bestThrough) {
+        std::vector<Instruction*> succs = getSuccs(inst);
+        for (std::vector<Instruction*>::iterator it2 = succs.begin(),
+               ie = succs.end(); it2 != ie; ++it2) {
+          uint64_t dist = sm.getIndexedValue(minDist,
+                                             infos.getInfo(*it2).id);
+          if (dist) {
+            uint64_t val = bestThrough + dist;
+            if (best==0 || val<best)
+              best = val;
+          }
+        }
+      }
+
+      if (best != cur) {
+        sm.setIndexedValue(minDist, 
+                           infos.getInfo(inst).id, 
+                           best);
+        changed = true;
+      }
+    }
+  } while (changed);
+}
+
 void StatsTracker::computeReachableUncovered() {
   KModule *km = executor.kmodule;
   Module *m = km->module;
@@ -1264,84 +1355,38 @@ void StatsTracker::computeReachableUncovered() {
   }
 #endif
 
-  // compute minDistToUncovered, 0 is unreachable
+  // compute minDistToUncovered, and minDistToFocusedUncovered counting
+  // only the uncovered instructions of focused functions; 0 is
+  // unreachable
   std::vector<Instruction *> instructions;
+  unsigned numFocusedUncovered = 0;
   for (Module::iterator fnIt = m->begin(), fn_ie = m->end(); 
        fnIt != fn_ie; ++fnIt) {
+    std::map<Function*, KFunction*>::iterator kfIt = km->functionMap.find(fnIt);
+    bool focused = kfIt != km->functionMap.end() && kfIt->second->isFocusedFunc;
     // Not sure if I should bother to preorder here.
     for (Function::iterator bbIt = fnIt->begin(), bb_ie = fnIt->end(); 
          bbIt != bb_ie; ++bbIt) {
       for (BasicBlock::iterator it = bbIt->begin(), ie = bbIt->end(); 
            it != ie; ++it) {
         unsigned id = infos.getInfo(it).id;
+        uint64_t uncovered = sm.getIndexedValue(stats::uncoveredInstructions, id);
         instructions.push_back(&*it);
-        sm.setIndexedValue(stats::minDistToUncovered, 
-                           id, 
-                           sm.getIndexedValue(stats::uncoveredInstructions, id));
+        sm.setIndexedValue(stats::minDistToUncovered, id, uncovered);
+        if (updateMinDistToFocused)
+          sm.setIndexedValue(stats::minDistToFocusedUncovered, id,
+                             focused ? uncovered : 0);
+        if (focused && uncovered)
+          ++numFocusedUncovered;
       }
     }
   }
   
   std::reverse(instructions.begin(), instructions.end());
   
-  // I'm so lazy it's not even worklisted.
-  bool changed;
-  do {
-    changed = false;
-    for (std::vector<Instruction*>::iterator it = instructions.begin(),
-           ie = instructions.end(); it != ie; ++it) {
-      Instruction *inst = *it;
-      uint64_t best, cur = best = sm.getIndexedValue(stats::minDistToUncovered, 
-                                                     infos.getInfo(inst).id);
-      unsigned bestThrough = 0;
-      
-      if (isa<CallInst>(inst) || isa<InvokeInst>(inst)) {
-        std::vector<Function*> &targets = callTargets[inst];
-        for (std::vector<Function*>::iterator fnIt = targets.begin(),
-               ie = targets.end(); fnIt != ie; ++fnIt) {
-          uint64_t dist = functionShortestPath[*fnIt];
-          if (dist) {
-            dist = 1+dist; // count instruction itself
-            if (bestThrough==0 || dist<bestThrough)
-              bestThrough = dist;
-          }
-
-          if (!(*fnIt)->isDeclaration()) {
-            uint64_t calleeDist = sm.getIndexedValue(stats::minDistToUncovered,
-                                                     infos.getFunctionInfo(*fnIt).id);
-            if (calleeDist) {
-              calleeDist = 1+calleeDist; // count instruction itself
-              if (best==0 || calleeDist<best)
-                best = calleeDist;
-            }
-          }
-        }
-      } else {
-        bestThrough = 1;
-      }
-      
-      if (bestThrough) {
-        std::vector<Instruction*> succs = getSuccs(inst);
-        for (std::vector<Instruction*>::iterator it2 = succs.begin(),
-               ie = succs.end(); it2 != ie; ++it2) {
-          uint64_t dist = sm.getIndexedValue(stats::minDistToUncovered,
-                                             infos.getInfo(*it2).id);
-          if (dist) {
-            uint64_t val = bestThrough + dist;
-            if (best==0 || val<best)
-              best = val;
-          }
-        }
-      }
-
-      if (best != cur) {
-        sm.setIndexedValue(stats::minDistToUncovered, 
-                           infos.getInfo(inst).id, 
-                           best);
-        changed = true;
-      }
-    }
-  } while (changed);
+  propagateMinDist(stats::minDistToUncovered, instructions);
+  if (updateMinDistToFocused)
+    propagateMinDist(stats::minDistToFocusedUncovered, instructions);
 
 #ifdef XQX_DEBUG_STATSTRACKER
   klee_xqx_debug("=====================minDistToUncovered=================");
@@ -1370,7 +1415,7 @@ void StatsTracker::computeReachableUncovered() {
   for (std::set<ExecutionState*>::iterator it = executor.states.begin(),
          ie = executor.states.end(); it != ie; ++it) {
     ExecutionState *es = *it;
-    uint64_t currentFrameMinDist = 0;
+    uint64_t currentFrameMinDist = 0, currentFrameMinDistToFocused = 0;
     for (ExecutionState::stack_ty::iterator sfIt = es->stack.begin(),
            sf_ie = es->stack.end(); sfIt != sf_ie; ++sfIt) {
       ExecutionState::stack_ty::iterator next = sfIt + 1;
@@ -1386,8 +1431,17 @@ void StatsTracker::computeReachableUncovered() {
       sfIt->minDistToUncoveredOnReturn = currentFrameMinDist;
       
       currentFrameMinDist = computeMinDistToUncovered(kii, currentFrameMinDist);
+
+      if (updateMinDistToFocused) {
+        sfIt->minDistToFocusedOnReturn = currentFrameMinDistToFocused;
+        currentFrameMinDistToFocused =
+          computeMinDistToFocusedUncovered(kii, currentFrameMinDistToFocused);
+      }
     }
   }
+
+  if (updateMinDistToFocused)
+    executor.pruneUnreachableStates(numFocusedUncovered);
 }
 
 
@@ -58,6 +58,7 @@ namespace klee {
     CallPathManager callPathManager;    
 
     bool updateMinDistToUncovered;
+    bool updateMinDistToFocused;
 
   public:
     static bool useStatistics();
@@ -74,11 +75,14 @@ namespace klee {
     void logCallInstHead();
     void logBBCallHead();
     void reportBBCoverage();
+    void propagateMinDist(const Statistic &minDist,
+                          const std::vector<llvm::Instruction*> &instructions);
     //void logCallInstLine();
 
   public:
     StatsTracker(Executor &_executor, std::string _objectFilename,
-                 bool _updateMinDistToUncovered);
+                 bool _updateMinDistToUncovered,
+                 bool _updateMinDistToFocused = false);
     ~StatsTracker();
 
     // called after a new StackFrame has been pushed (for callpath tracing)
@@ -115,6 +119,11 @@ namespace klee {
   uint64_t computeMinDistToUncovered(const KInstruction *ki,
                                      uint64_t minDistAtRA);
 
+  /// Like computeMinDistToUncovered, counting only the uncovered
+  /// instructions of focused functions.
+  uint64_t computeMinDistToFocusedUncovered(const KInstruction *ki,
+                                            uint64_t minDistAtRA);
+
 }
 
 #endif
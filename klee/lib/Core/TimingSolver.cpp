@@ -40,7 +40,7 @@ ref<Expr> TimingSolver::ZESTEvaluate(const ExecutionState& state, ref<Expr> expr
     std::vector<SeedInfo>::iterator siit = its->second.begin();
 
     if (siit != its->second.end()) {
-      return siit->assignment.evaluate(expr);
+      return siit->evaluate(expr);
     }
   }
   return expr;
@@ -131,6 +131,31 @@ bool TimingSolver::mayBeFalse(const ExecutionState& state, ref<Expr> expr,
   return true;
 }
 
+bool TimingSolver::mayBeTrue(const ExecutionState& state, 
+                             const std::vector< ref<Expr> > &exprs,
+                             std::vector<bool> &results, bool useSeeds) {
+  std::vector< ref<Expr> > queries(exprs);
+  for (std::vector< ref<Expr> >::iterator it = queries.begin(),
+         ie = queries.end(); it != ie; ++it) {
+    if (seedMap && useSeeds)
+      *it = ZESTEvaluate(state, *it);
+    if (simplifyExprs)
+      *it = state.constraints.simplifyExpr(*it);
+  }
+
+  sys::TimeValue now(0,0),user(0,0),delta(0,0),sys(0,0);
+  sys::Process::GetTimeUsage(now,user,sys);
+
+  bool success = solver->mayBeTrue(state.constraints, queries, results);
+
+  sys::Process::GetTimeUsage(delta,user,sys);
+  delta -= now;
+  stats::solverTime += delta.usec();
+  state.queryCost += delta.usec()/1000000.;
+
+  return success;
+}
+
 bool TimingSolver::getValue(const ExecutionState& state, ref<Expr> expr, 
                             ref<ConstantExpr> &result, bool useSeeds) {
 #ifdef XQX_CONCRETE_EXEC
@@ -193,3 +218,21 @@ TimingSolver::getRange(const ExecutionState& state, ref<Expr> expr, bool useSeed
   }
   return solver->getRange(Query(state.constraints, expr));
 }
+
+bool TimingSolver::getRange(const ExecutionState& state, ref<Expr> expr,
+                            uint64_t &min, uint64_t &max) {
+  sys::TimeValue now(0,0),user(0,0),delta(0,0),sys(0,0);
+  sys::Process::GetTimeUsage(now,user,sys);
+
+  if (simplifyExprs)
+    expr = state.constraints.simplifyExpr(expr);
+
+  bool success = solver->getRange(Query(state.constraints, expr), min, max);
+
+  sys::Process::GetTimeUsage(delta,user,sys);
+  delta -= now;
+  stats::solverTime += delta.usec();
+  state.queryCost += delta.usec()/1000000.;
+
+  return success;
+}
@@ -69,6 +69,12 @@ namespace klee {
 
     bool mayBeFalse(const ExecutionState&, ref<Expr>, bool &result, bool useSeeds = false);
 
+    /// Batched mayBeTrue: results[i] is set iff exprs[i] may be true in
+    /// the given state. All expressions are answered in one solver
+    /// session over the state's constraints.
+    bool mayBeTrue(const ExecutionState&, const std::vector< ref<Expr> > &exprs,
+                   std::vector<bool> &results, bool useSeeds = false);
+
     bool getValue(const ExecutionState &, ref<Expr> expr, 
                   ref<ConstantExpr> &result, bool useSeeds = false);
 
@@ -79,6 +85,11 @@ namespace klee {
 
     std::pair< ref<Expr>, ref<Expr> >
     getRange(const ExecutionState&, ref<Expr> query, bool useSeeds = false);
+
+    /// Like getRange, but fails rather than asserting when the solver
+    /// cannot answer the whole range in a single context.
+    bool getRange(const ExecutionState&, ref<Expr> expr,
+                  uint64_t &min, uint64_t &max);
 #if 0 
     bool evaluate(const ExecutionState&, ref<Expr>, Solver::Validity &result);
 
@@ -28,6 +28,7 @@ namespace {
 			clEnumValN(Searcher::RandomPath, "random-path", "use Random Path Selection (see OSDI'08 paper)"),
 			clEnumValN(Searcher::NURS_CovNew, "nurs:covnew", "use Non Uniform Random Search (NURS) with Coverage-New"),
 			clEnumValN(Searcher::NURS_MD2U, "nurs:md2u", "use NURS with Min-Dist-to-Uncovered"),
+			clEnumValN(Searcher::NURS_FD2U, "nurs:fd2u", "use NURS with Min-Dist-to-Uncovered in the focused functions"),
 			clEnumValN(Searcher::NURS_Depth, "nurs:depth", "use NURS with 2^depth"),
 			clEnumValN(Searcher::NURS_ICnt, "nurs:icnt", "use NURS with Instr-Count"),
 			clEnumValN(Searcher::NURS_CPICnt, "nurs:cpicnt", "use NURS with CallPath-Instr-Count"),
@@ -63,17 +64,36 @@ namespace {
   UseBumpMerge("use-bump-merge", 
            cl::desc("Enable support for klee_merge() (extra experimental)"));
 
+  cl::opt<bool>
+  UseAutoMerge("use-auto-merge", 
+           cl::desc("Merge states at the join points of focused functions without klee_merge() (experimental)"));
+
+  cl::opt<unsigned>
+  AutoMergeMaxHeld("auto-merge-max-held",
+           cl::desc("Number of states held at join points before they are merged (default=64)"),
+           cl::init(64));
+
+  cl::opt<unsigned>
+  AutoMergeMaxCost("auto-merge-max-cost",
+           cl::desc("Maximum number of select expressions a single automatic merge may create (default=4096)"),
+           cl::init(4096));
+
 }
 
 
 bool klee::userSearcherRequiresMD2U() {
   return (std::find(CoreSearch.begin(), CoreSearch.end(), Searcher::NURS_MD2U) != CoreSearch.end() ||
+	  userSearcherRequiresFD2U() ||
 	  std::find(CoreSearch.begin(), CoreSearch.end(), Searcher::NURS_CovNew) != CoreSearch.end() ||
 	  std::find(CoreSearch.begin(), CoreSearch.end(), Searcher::NURS_ICnt) != CoreSearch.end() ||
 	  std::find(CoreSearch.begin(), CoreSearch.end(), Searcher::NURS_CPICnt) != CoreSearch.end() ||
 	  std::find(CoreSearch.begin(), CoreSearch.end(), Searcher::NURS_QC) != CoreSearch.end());
 }
 
+bool klee::userSearcherRequiresFD2U() {
+  return std::find(CoreSearch.begin(), CoreSearch.end(), Searcher::NURS_FD2U) != CoreSearch.end();
+}
+
 
 Searcher *getNewSearcher(Searcher::CoreSearchType type, Executor &executor) {
   Searcher *searcher = NULL;
@@ -84,6 +104,7 @@ Searcher *getNewSearcher(Searcher::CoreSearchType type, Executor &executor) {
   case Searcher::RandomPath: searcher = new RandomPathSearcher(executor); break;
   case Searcher::NURS_CovNew: searcher = new WeightedRandomSearcher(executor, WeightedRandomSearcher::CoveringNew); break;
   case Searcher::NURS_MD2U: searcher = new WeightedRandomSearcher(executor, WeightedRandomSearcher::MinDistToUncovered); break;
+  case Searcher::NURS_FD2U: searcher = new WeightedRandomSearcher(executor, WeightedRandomSearcher::MinDistToFocused); break;
   case Searcher::NURS_Depth: searcher = new WeightedRandomSearcher(executor, WeightedRandomSearcher::Depth); break;
   case Searcher::NURS_ICnt: searcher = new WeightedRandomSearcher(executor, WeightedRandomSearcher::InstCount); break;
   case Searcher::NURS_CPICnt: searcher = new WeightedRandomSearcher(executor, WeightedRandomSearcher::CPInstCount); break;
@@ -99,7 +120,10 @@ Searcher *klee::constructUserSearcher(Executor &executor) {
 
   // default values
   if (CoreSearch.size() == 0) {
-    CoreSearch.push_back(Searcher::RandomPath);
+    // random-path selects states from the process tree, so it would
+    // pick states held at a join point
+    if (!UseAutoMerge)
+      CoreSearch.push_back(Searcher::RandomPath);
     CoreSearch.push_back(Searcher::NURS_CovNew);
   }
 
@@ -126,6 +150,11 @@ Searcher *klee::constructUserSearcher(Executor &executor) {
     searcher = new MergingSearcher(executor, searcher);
   } else if (UseBumpMerge) {
     searcher = new BumpMergingSearcher(executor, searcher);
+  } else if (UseAutoMerge) {
+    if (std::find(CoreSearch.begin(), CoreSearch.end(), Searcher::RandomPath) != CoreSearch.end())
+      klee_error("--use-auto-merge cannot be used with --search=random-path");
+    searcher = new AutoMergingSearcher(executor, searcher, AutoMergeMaxHeld,
+                                       AutoMergeMaxCost);
   }
   
   if (UseIterativeDeepeningTimeSearch) {
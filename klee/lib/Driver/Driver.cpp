@@ -0,0 +1,567 @@
+//===-- Driver.cpp --------------------------------------------------------===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "../Core/Common.h"
+
+#include "klee/Interpreter.h"
+#include "klee/Internal/ADT/KTest.h"
+#include "klee/Internal/Support/Driver.h"
+
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/system_error.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+
+using namespace klee;
+using namespace llvm;
+
+namespace {
+  struct CoversMoreBlocks {
+    const std::vector<unsigned> &counts;
+    CoversMoreBlocks(const std::vector<unsigned> &_counts) : counts(_counts) {}
+    bool operator()(unsigned a, unsigned b) const {
+      return counts[a] > counts[b];
+    }
+  };
+}
+
+void klee::distillSeeds(Interpreter *interpreter, InterpreterHandler *handler,
+                        Function *mainFn, int argc, char **argv, char **envp,
+                        std::vector<KTest *> &seeds,
+                        const std::vector<std::string> &seedFiles,
+                        unsigned extra, const bool &interrupted) {
+  std::vector< std::vector<bool> > blocks(seeds.size());
+  std::vector<unsigned> counts(seeds.size(), 0);
+
+  for (unsigned i = 0; i != seeds.size() && !interrupted; ++i) {
+    klee_message("distilling seeds: replaying %s (%u/%u)",
+                 seedFiles[i].c_str(), i + 1, (unsigned) seeds.size());
+    interpreter->setReplayOut(seeds[i]);
+    interpreter->setBlockCoverage(&blocks[i]);
+    interpreter->runFunctionAsMain(mainFn, argc, argv, envp);
+    counts[i] = std::count(blocks[i].begin(), blocks[i].end(), true);
+  }
+  interpreter->setBlockCoverage(0);
+  interpreter->setReplayOut(0);
+  if (interrupted)
+    return;
+
+  std::vector<bool> covered, isKept(seeds.size(), false);
+  std::vector<unsigned> kept, added, rest;
+  while (1) {
+    unsigned best = 0, bestGain = 0;
+    for (unsigned i = 0; i != seeds.size(); ++i) {
+      if (isKept[i])
+        continue;
+      unsigned gain = 0;
+      for (unsigned b = 0; b != blocks[i].size(); ++b)
+        if (blocks[i][b] && (b >= covered.size() || !covered[b]))
+          ++gain;
+      if (gain > bestGain) {
+        best = i;
+        bestGain = gain;
+      }
+    }
+    if (bestGain == 0)
+      break;
+
+    isKept[best] = true;
+    kept.push_back(best);
+    added.push_back(bestGain);
+    if (covered.size() < blocks[best].size())
+      covered.resize(blocks[best].size());
+    for (unsigned b = 0; b != blocks[best].size(); ++b)
+      if (blocks[best][b])
+        covered[b] = true;
+  }
+  for (unsigned i = 0; i != seeds.size(); ++i)
+    if (!isKept[i])
+      rest.push_back(i);
+  std::stable_sort(rest.begin(), rest.end(), CoversMoreBlocks(counts));
+
+  std::ostream *os = handler->openOutputFile("distilled-seeds.txt");
+  std::vector<KTest *> distilled;
+  for (unsigned k = 0; k != kept.size(); ++k) {
+    unsigned i = kept[k];
+    if (os)
+      *os << "keep\t" << seedFiles[i] << "\t" << counts[i] << " blocks\t"
+          << added[k] << " new\n";
+    distilled.push_back(seeds[i]);
+  }
+  for (unsigned k = 0; k != rest.size(); ++k) {
+    unsigned i = rest[k];
+    bool isExtra = k < extra;
+    if (os)
+      *os << (isExtra ? "extra\t" : "skip\t") << seedFiles[i] << "\t"
+          << counts[i] << " blocks\n";
+    if (isExtra)
+      distilled.push_back(seeds[i]);
+    else
+      kTest_free(seeds[i]);
+  }
+  delete os;
+
+  klee_message("distilled %u seeds to %u covering %u blocks",
+               (unsigned) seeds.size(), (unsigned) distilled.size(),
+               (unsigned) std::count(covered.begin(), covered.end(), true));
+  seeds = distilled;
+}
+
+bool klee::readSymConfigFile(const std::string &confFile,
+                             const std::string &defaultPath,
+                             unsigned defaultMethod,
+                             std::vector<Interpreter::ConcolicFile> &files) {
+  std::ifstream ifs(confFile.c_str(), std::ios::in);
+  if (!ifs.good()) {
+    klee_message("open configure file error: %s", confFile.c_str());
+    return false;
+  }
+
+  std::map<std::string, unsigned> fileIndex;
+  std::string path = defaultPath;
+  std::string sLine;
+  while (getline(ifs, sLine)) {
+    if (!sLine.empty() && sLine[0] == '@') {
+      path = sLine.substr(1);
+      continue;
+    }
+
+    std::istringstream line(sLine);
+    std::string token;
+    while (getline(line, token, ',')) {
+      if (token.find_first_not_of(" \t\r") == std::string::npos)
+        continue;
+
+      std::istringstream ts(token);
+      unsigned offset, length, method = defaultMethod;
+      char dash, colon;
+      if (!(ts >> offset >> dash >> length) || dash != '-' ||
+          ((ts >> colon) && (colon != ':' || !(ts >> method))))
+        klee_error("symconfigfile parsing error: %s", token.c_str());
+      if (path.empty())
+        klee_error("symconfigfile: no file for range %s", token.c_str());
+
+      std::map<std::string, unsigned>::iterator it = fileIndex.find(path);
+      if (it == fileIndex.end()) {
+        it = fileIndex.insert(std::make_pair(path, files.size())).first;
+        files.push_back(Interpreter::ConcolicFile());
+        files.back().path = path;
+      }
+      files[it->second].ranges.push_back(
+        Interpreter::ConcolicRange(offset, length, method));
+    }
+  }
+
+  return true;
+}
+
+void klee::writeInferredSymRanges(Interpreter *interpreter,
+                                  InterpreterHandler *handler,
+                                  const std::vector<Interpreter::ConcolicFile> &files) {
+  std::map<std::string, std::map<unsigned, unsigned> > bytes;
+  interpreter->getBranchInputBytes(bytes);
+
+  std::ostream *os = handler->openOutputFile("sym-ranges.conf");
+  if (!os) {
+    klee_warning("unable to write inferred symbolic ranges");
+    return;
+  }
+
+  unsigned total = 0;
+  for (unsigned i = 0; i != files.size(); ++i) {
+    std::map<std::string, std::map<unsigned, unsigned> >::iterator it =
+      bytes.find(files[i].path);
+    if (it == bytes.end())
+      continue;
+
+    // (branches reached, (offset, length)) of each run of bytes
+    std::vector< std::pair<unsigned, std::pair<unsigned, unsigned> > > ranges;
+    for (std::map<unsigned, unsigned>::iterator bi = it->second.begin(),
+           be = it->second.end(); bi != be; ++bi) {
+      if (!ranges.empty()) {
+        std::pair<unsigned, unsigned> &last = ranges.back().second;
+        if (last.first + last.second == bi->first) {
+          ++last.second;
+          ranges.back().first += bi->second;
+          continue;
+        }
+      }
+      ranges.push_back(std::make_pair(bi->second,
+                                      std::make_pair(bi->first, 1u)));
+    }
+    std::sort(ranges.begin(), ranges.end());
+
+    *os << "@" << files[i].path << "\n";
+    for (unsigned j = ranges.size(); j != 0; --j)
+      *os << ranges[j-1].second.first << "-"
+          << ranges[j-1].second.second << "\n";
+    total += ranges.size();
+  }
+  delete os;
+
+  klee_message("wrote %u inferred symbolic ranges to %s", total,
+               handler->getOutputFilename("sym-ranges.conf").c_str());
+}
+
+/// How the values of an istats event are merged: '>' takes the maximum,
+/// '<' the minimum and '+' the sum.
+static char combineEvent(const std::string &event) {
+  // covered by any worker
+  if (event == "Icov" || event == "IFcov")
+    return '>';
+  // left uncovered by every worker, the shortest distance of any
+  if (event == "Iuncov" || event == "IFuncov" || event == "IuncovReach" ||
+      (event.size() >= 4 && event.compare(event.size() - 4, 4, "dist") == 0))
+    return '<';
+  return '+';
+}
+
+/// Merge the run.istats of the workers.  They all print the same module
+/// with the functions in order, so the cost lines are combined column by
+/// column as combineEvent() says.  The summary: and totals: lines, if
+/// any, are recomputed from the merged cost lines, leaving out the
+/// inclusive costs of calls.
+bool klee::mergeRunIStats(const std::vector<std::string> &inputs,
+                          const std::string &output) {
+  std::vector<std::string> lines;
+  std::vector< std::vector<uint64_t> > costs;
+  std::vector<bool> isCallCost;
+  std::vector<char> combine;  // '+', '<' or '>' for each column
+
+  for (unsigned i = 0; i != inputs.size(); ++i) {
+    std::ifstream in(inputs[i].c_str());
+    if (!in) {
+      klee_warning("unable to open %s", inputs[i].c_str());
+      return false;
+    }
+
+    unsigned k = 0;
+    bool afterCalls = false;
+    std::string line;
+    while (std::getline(in, line)) {
+      if (i == 0) {
+        lines.push_back(line);
+        costs.push_back(std::vector<uint64_t>());
+        isCallCost.push_back(false);
+      } else if (k == lines.size()) {
+        klee_warning("%s does not match %s", inputs[i].c_str(),
+                     inputs[0].c_str());
+        return false;
+      }
+
+      if (i == 0 && line.compare(0, 7, "events:") == 0) {
+        // the cost lines start with the instr and line positions
+        std::istringstream events(line.substr(7));
+        std::string event;
+        combine.assign(2, '=');
+        while (events >> event)
+          combine.push_back(combineEvent(event));
+      }
+
+      if (line.empty() || !isdigit(line[0])) {
+        // the cost line after calls= is the inclusive cost of the call
+        afterCalls = line.compare(0, 6, "calls=") == 0;
+        ++k;
+        continue;
+      }
+
+      std::istringstream fields(line);
+      std::vector<uint64_t> values;
+      uint64_t value;
+      while (fields >> value)
+        values.push_back(value);
+
+      if (i == 0)
+        isCallCost[k] = afterCalls;
+      afterCalls = false;
+
+      std::vector<uint64_t> &cost = costs[k++];
+      if (i == 0) {
+        cost = values;
+        continue;
+      }
+      if (values.size() != cost.size() || values[0] != cost[0]) {
+        klee_warning("%s does not match %s", inputs[i].c_str(),
+                     inputs[0].c_str());
+        return false;
+      }
+      for (unsigned c = 2; c < values.size(); ++c) {
+        char op = c < combine.size() ? combine[c] : '=';
+        if (op == '+')
+          cost[c] += values[c];
+        else if (op == '<')
+          cost[c] = std::min(cost[c], values[c]);
+        else if (op == '>')
+          cost[c] = std::max(cost[c], values[c]);
+      }
+    }
+    if (k != lines.size()) {
+      klee_warning("%s does not match %s", inputs[i].c_str(),
+                   inputs[0].c_str());
+      return false;
+    }
+  }
+
+  std::vector<uint64_t> totals(combine.size() > 2 ? combine.size() - 2 : 0, 0);
+  for (unsigned k = 0; k != lines.size(); ++k) {
+    if (isCallCost[k])
+      continue;
+    for (unsigned e = 0; e != totals.size() && e + 2 < costs[k].size(); ++e)
+      totals[e] += costs[k][e + 2];
+  }
+
+  std::ofstream out(output.c_str());
+  for (unsigned k = 0; k != lines.size(); ++k) {
+    const std::string &line = lines[k];
+    if (line.compare(0, 8, "summary:") == 0 ||
+        line.compare(0, 7, "totals:") == 0) {
+      out << line.substr(0, line.find(':') + 1);
+      for (unsigned e = 0; e != totals.size(); ++e)
+        out << " " << totals[e];
+      out << "\n";
+      continue;
+    }
+    if (costs[k].empty()) {
+      out << line << "\n";
+      continue;
+    }
+    for (unsigned c = 0; c != costs[k].size(); ++c)
+      out << costs[k][c] << " ";
+    out << "\n";
+  }
+  return out.good();
+}
+
+unsigned klee::collectTestCases(InterpreterHandler *handler,
+                                const std::string &dir,
+                                unsigned &testIndex) {
+  sys::Path p(dir);
+  std::set<sys::Path> contents;
+  std::string error;
+  if (p.getDirectoryContents(contents, &error)) {
+    klee_warning("unable to read %s: %s", dir.c_str(), error.c_str());
+    return 0;
+  }
+
+  std::map<unsigned, unsigned> ids;
+  for (std::set<sys::Path>::iterator it = contents.begin(),
+         ie = contents.end(); it != ie; ++it) {
+    std::string name = sys::path::filename(it->str()).str();
+    // testNNNNNN.suffix
+    if (name.size() <= 11 || name.compare(0, 4, "test") != 0 ||
+        name[10] != '.')
+      continue;
+    unsigned id = atoi(name.substr(4, 6).c_str());
+    if (!ids.count(id))
+      ids[id] = ++testIndex;
+
+    char buf[32];
+    snprintf(buf, sizeof(buf), "test%06u", ids[id]);
+    std::string target =
+      handler->getOutputFilename(std::string(buf) + name.substr(10));
+    std::ifstream in(it->c_str(), std::ios::in | std::ios::binary);
+    std::ofstream out(target.c_str(), std::ios::out | std::ios::binary);
+    if (in.peek() != EOF)
+      out << in.rdbuf();
+  }
+  return ids.size();
+}
+
+static std::string strip(const std::string &in) {
+  std::string::size_type lo = in.find_first_not_of(" \t\r\n");
+  if (lo == std::string::npos)
+    return "";
+  std::string::size_type hi = in.find_last_not_of(" \t\r\n");
+  return in.substr(lo, hi - lo + 1);
+}
+
+/// Return true if \a arg sets the option \a name, and set \a valueFollows
+/// if its value, if any, is in the next argument.
+static bool isOptionArgument(const std::string &arg, const char *name,
+                             bool &valueFollows) {
+  std::string::size_type start = arg.find_first_not_of('-');
+  if (start == 0 || start == std::string::npos)
+    return false;
+  std::string::size_type eq = arg.find('=', start);
+  valueFollows = (eq == std::string::npos);
+  return arg.substr(start, eq == std::string::npos ? eq : eq - start) == name;
+}
+
+/// Options each --run-func-list worker is given its own value of.
+static const struct {
+  const char *name;
+  bool hasValue;
+} workerOptions[] = {
+  { "run-func-list", true },
+  { "run-func-jobs", true },
+  { "run-func-time", true },
+  { "run-func", true },
+  { "output-dir", true },
+  { "max-time", true },
+  { "watchdog", false }
+};
+
+unsigned klee::runFunctionList(InterpreterHandler *handler,
+                               const char *program,
+                               const std::vector<std::string> &arguments,
+                               const FunctionListOptions &opts,
+                               const bool &interrupted) {
+  std::vector<std::string> funcs;
+  std::ifstream list(opts.listFile.c_str());
+  if (!list)
+    klee_error("unable to open function list: %s", opts.listFile.c_str());
+  std::string line;
+  while (std::getline(list, line)) {
+    line = strip(line);
+    // skip the "total number = N" trailer of focusedFuncs.txt
+    if (line.empty() || line.find_first_of(" \t=") != std::string::npos)
+      continue;
+    if (std::find(funcs.begin(), funcs.end(), line) == funcs.end())
+      funcs.push_back(line);
+  }
+  if (funcs.empty())
+    klee_error("no functions in %s", opts.listFile.c_str());
+
+  double budget = opts.funcTime ? opts.funcTime : opts.maxTime;
+  if (opts.watchdog && budget == 0)
+    klee_error("--watchdog used without --max-time or --run-func-time");
+
+  // Pass the options on to the workers, but for their own ones, and
+  // the arguments of the program after the input file as they are.
+  std::vector<std::string> common, programArgs;
+  unsigned a = 0;
+  for (; a < arguments.size() && arguments[a] != opts.inputFile; ++a) {
+    bool own = false, valueFollows = false;
+    for (unsigned j = 0;
+         j != sizeof(workerOptions) / sizeof(workerOptions[0]); ++j) {
+      if (isOptionArgument(arguments[a], workerOptions[j].name,
+                           valueFollows)) {
+        own = true;
+        if (workerOptions[j].hasValue && valueFollows)
+          ++a;
+        break;
+      }
+    }
+    if (!own)
+      common.push_back(arguments[a]);
+  }
+  programArgs.assign(arguments.begin() +
+                     std::min(a, (unsigned) arguments.size()),
+                     arguments.end());
+
+  unsigned jobs = opts.jobs;
+  if (jobs == 0) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    jobs = n > 0 ? n : 1;
+  }
+
+  std::vector<std::string> dirs(funcs.size());
+  std::vector<int> results(funcs.size(), -1);
+  std::map<pid_t, unsigned> running;
+  unsigned next = 0;
+  while (next < funcs.size() || !running.empty()) {
+    while (!interrupted && next < funcs.size() && running.size() < jobs) {
+      unsigned f = next++;
+      dirs[f] = handler->getOutputFilename("func-" + funcs[f]);
+
+      std::vector<std::string> args;
+      args.push_back(program);
+      args.insert(args.end(), common.begin(), common.end());
+      args.push_back("--run-func=" + funcs[f]);
+      args.push_back("--output-dir=" + dirs[f]);
+      if (budget > 0) {
+        std::ostringstream maxTime;
+        maxTime << "--max-time=" << budget;
+        args.push_back(maxTime.str());
+        if (opts.funcTime || opts.watchdog)
+          args.push_back("--watchdog");
+      }
+      args.insert(args.end(), programArgs.begin(), programArgs.end());
+
+      std::string log = dirs[f] + ".log";
+      pid_t pid = fork();
+      if (pid < 0)
+        klee_error("unable to fork worker for %s", funcs[f].c_str());
+      if (pid == 0) {
+        int fd = open(log.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd >= 0) {
+          dup2(fd, 1);
+          dup2(fd, 2);
+          close(fd);
+        }
+        std::vector<char*> cargs;
+        for (unsigned k = 0; k != args.size(); ++k)
+          cargs.push_back(const_cast<char*>(args[k].c_str()));
+        cargs.push_back(0);
+        execvp(cargs[0], &cargs[0]);
+        perror("execvp");
+        _exit(127);
+      }
+      running[pid] = f;
+      klee_message("worker %d: running %s (%u/%u)", pid, funcs[f].c_str(),
+                   f + 1, (unsigned) funcs.size());
+    }
+    if (running.empty())
+      break;
+
+    int status;
+    pid_t pid = waitpid(-1, &status, 0);
+    if (pid < 0) {
+      if (errno == EINTR)
+        continue;
+      perror("waitpid");
+      break;
+    }
+    std::map<pid_t, unsigned>::iterator it = running.find(pid);
+    if (it == running.end())
+      continue;
+    results[it->second] = WIFEXITED(status) ? WEXITSTATUS(status) :
+      128 + WTERMSIG(status);
+    running.erase(it);
+  }
+
+  std::ostream &infoFile = handler->getInfoStream();
+  unsigned testIndex = 0;
+  std::vector<std::string> istats;
+  for (unsigned f = 0; f != funcs.size(); ++f) {
+    if (results[f] < 0) {
+      infoFile << "KLEE: run-func " << funcs[f] << ": not run\n";
+      continue;
+    }
+    bool isDir = false;
+    sys::fs::is_directory(dirs[f], isDir);
+    unsigned tests = isDir ? collectTestCases(handler, dirs[f], testIndex) : 0;
+    infoFile << "KLEE: run-func " << funcs[f] << ": exit status "
+             << results[f] << ", " << tests << " tests\n";
+
+    std::string path = dirs[f] + "/run.istats";
+    bool exists = false;
+    if (isDir && sys::fs::exists(path, exists) == errc::success && exists)
+      istats.push_back(path);
+  }
+  if (!istats.empty() &&
+      mergeRunIStats(istats, handler->getOutputFilename("run.istats")))
+    klee_message("merged the coverage of %u workers into %s",
+                 (unsigned) istats.size(),
+                 handler->getOutputFilename("run.istats").c_str());
+
+  return testIndex;
+}
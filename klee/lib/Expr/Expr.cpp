@@ -483,6 +483,33 @@ ref<Expr>  NotOptimizedExpr::create(ref<Expr> src) {
 
 extern "C" void vc_DeleteExpr(void*);
 
+/// Pack the bytes of the given constant values into shared contents,
+/// or return null for a symbolic array.
+static ArrayContents *createArrayContents(const ref<ConstantExpr> *begin,
+                                          const ref<ConstantExpr> *end) {
+  if (begin == end)
+    return 0;
+
+  std::vector<uint8_t> bytes;
+  bytes.reserve(end - begin);
+  for (const ref<ConstantExpr> *it = begin; it != end; ++it) {
+    assert((*it)->getWidth() == Expr::Int8 &&
+           "Invalid initial constant value!");
+    bytes.push_back((*it)->getZExtValue(8));
+  }
+  return new ArrayContents(&bytes[0], &bytes[0] + bytes.size());
+}
+
+Array::Array(const std::string &_name, uint64_t _size, 
+             const ref<ConstantExpr> *constantValuesBegin,
+             const ref<ConstantExpr> *constantValuesEnd)
+  : name(_name), size(_size), 
+    contents(createArrayContents(constantValuesBegin, constantValuesEnd)) {
+  assert((isSymbolicArray() || contents->size() == size) &&
+         "Invalid size for constant array!");
+  computeHash();
+}
+
 Array::~Array() {
 }
 
@@ -995,9 +1022,11 @@ static ref<Expr> TryConstArrayOpt(const ref<ConstantExpr> &cl,
 
   // for now, just assume standard "flushing" of a concrete array,
   // where the concrete array has one update for each index, in order
+  const Array *root = rd->updates.root;
+  uint64_t value = cl->getZExtValue();
   ref<Expr> res = ConstantExpr::alloc(0, Expr::Bool);
-  for (unsigned i = 0, e = rd->updates.root->size; i != e; ++i) {
-    if (cl == rd->updates.root->constantValues[i]) {
+  for (unsigned i = 0, e = root->size; i != e; ++i) {
+    if (value == root->getConstantValue(i)) {
       // Arbitrary maximum on the size of disjunction.
       if (++numMatches > 100)
         return EqExpr_create(cl, rd);
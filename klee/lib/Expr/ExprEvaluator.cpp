@@ -31,7 +31,7 @@ ExprVisitor::Action ExprEvaluator::evalRead(const UpdateList &ul,
   }
   
   if (ul.root->isConstantArray() && index < ul.root->size)
-    return Action::changeTo(ul.root->constantValues[index]);
+    return Action::changeTo(ul.root->getConstantExpr(index));
 
   return Action::changeTo(getInitialValue(*ul.root, index));
 }
@@ -493,7 +493,7 @@ void ExprPPrinter::printQuery(std::ostream &os,
         for (unsigned i = 0, e = A->size; i != e; ++i) {
           if (i)
             PC << " ";
-          PC << A->constantValues[i];
+          PC << (unsigned) A->getConstantValue(i);
         }
         PC << "]";
       }
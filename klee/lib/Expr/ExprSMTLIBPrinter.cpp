@@ -484,14 +484,12 @@ namespace klee
 			for(set<const Array*>::iterator it = usedArrays.begin(); it != usedArrays.end(); it++)
 			{
 				array= *it;
-				int byteIndex=0;
 				if(array->isConstantArray())
 				{
 					/*loop over elements in the array and generate an assert statement
 					  for each one
 					 */
-					for(vector< ref<ConstantExpr> >::const_iterator ce= array->constantValues.begin();
-							ce != array->constantValues.end(); ce++, byteIndex++)
+					for(unsigned byteIndex=0; byteIndex != array->size; byteIndex++)
 					{
 						*p << "(assert (";
 						p->pushIndent();
@@ -501,7 +499,7 @@ namespace klee
 
 						*p << "(select " << array->name << " (_ bv" << byteIndex << " " << array->getDomain() << ") )";
 						printSeperator();
-						printConstant((*ce));
+						printConstant(array->getConstantExpr(byteIndex));
 
 						p->popIndent();
 						printSeperator();
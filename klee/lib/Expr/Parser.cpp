@@ -1575,7 +1575,7 @@ void ArrayDecl::dump() {
     for (unsigned i = 0, e = Root->size; i != e; ++i) {
       if (i)
         std::cout << " ";
-      std::cout << Root->constantValues[i];
+      std::cout << (unsigned) Root->getConstantValue(i);
     }
     std::cout << "]\n";
   }
@@ -0,0 +1,310 @@
+//===-- ChecksumBypass.cpp ------------------------------------------------===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Passes.h"
+
+#include "klee/Config/Version.h"
+
+#if LLVM_VERSION_CODE >= LLVM_VERSION(3, 3)
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Operator.h"
+#include "llvm/IR/Type.h"
+#else
+#include "llvm/Constants.h"
+#include "llvm/Function.h"
+#include "llvm/Instructions.h"
+#include "llvm/LLVMContext.h"
+#include "llvm/Module.h"
+#include "llvm/Operator.h"
+#include "llvm/Type.h"
+#endif
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <sstream>
+#include <vector>
+
+using namespace llvm;
+using namespace klee;
+
+char ChecksumBypassPass::ID;
+
+namespace {
+  /// Features of the expressions an accumulator is updated with.
+  enum {
+    UpdateSelf = 1 << 0,      // reads the accumulator itself
+    UpdateXor = 1 << 1,
+    UpdateAdd = 1 << 2,
+    UpdateMul = 1 << 3,
+    UpdateShift = 1 << 4,
+    UpdatePoly = 1 << 5,      // a well-known CRC polynomial
+    UpdateModulus = 1 << 6,   // reduction modulo an Adler/Fletcher base
+    UpdateTable = 1 << 7,     // load from a constant global table
+    UpdateByte = 1 << 8       // load of a byte
+  };
+
+  /// A memory location values are passed through: an alloca or
+  /// global, or a constant-index element of one or of a pointer type.
+  typedef std::pair<const void*, std::string> Location;
+}
+
+static bool isCRCPolynomial(uint64_t v) {
+  switch (v) {
+  case 0xEDB88320: case 0x04C11DB7:   // CRC-32
+  case 0x82F63B78: case 0x1EDC6F41:   // CRC-32C
+  case 0xA001: case 0x8005:           // CRC-16
+  case 0x8408: case 0x1021:           // CRC-CCITT
+    return true;
+  default:
+    return false;
+  }
+}
+
+static bool isChecksumModulus(uint64_t v) {
+  return v == 65521 || v == 65535 || v == 255;
+}
+
+static bool isChecksumUpdate(unsigned f) {
+  if (!(f & UpdateSelf))
+    return false;
+  if ((f & UpdateXor) && (f & UpdateTable))
+    return true;
+  if ((f & UpdateXor) && (f & UpdateShift) && (f & UpdatePoly))
+    return true;
+  if (f & UpdateModulus)
+    return true;
+  return (f & UpdateAdd) && (f & UpdateByte) &&
+         !(f & (UpdateMul | UpdateShift));
+}
+
+static bool getLocation(Value *ptr, Location &loc) {
+  ptr = ptr->stripPointerCasts();
+  if (isa<AllocaInst>(ptr) || isa<GlobalVariable>(ptr)) {
+    loc = Location(ptr, "");
+    return true;
+  }
+
+  GEPOperator *gep = dyn_cast<GEPOperator>(ptr);
+  if (!gep || !gep->hasAllConstantIndices())
+    return false;
+  std::ostringstream indices;
+  for (User::op_iterator it = gep->idx_begin(), ie = gep->idx_end();
+       it != ie; ++it)
+    indices << cast<ConstantInt>(*it)->getZExtValue() << ".";
+  Value *base = gep->getPointerOperand()->stripPointerCasts();
+  if (isa<AllocaInst>(base) || isa<GlobalVariable>(base))
+    loc = Location(base, indices.str());
+  else
+    loc = Location(base->getType(), indices.str());
+  return true;
+}
+
+/// Collect the features of \a v, an update of the accumulator \a acc
+/// (a PHI node, or an alloca read back through loads).
+static unsigned getUpdateFeatures(Value *v, Value *acc, unsigned depth,
+                                  std::set<Value*> &visited) {
+  if (v == acc)
+    return UpdateSelf;
+  if (depth == 0 || !visited.insert(v).second)
+    return 0;
+
+  if (ConstantInt *ci = dyn_cast<ConstantInt>(v))
+    return (ci->getBitWidth() <= 64 && isCRCPolynomial(ci->getZExtValue())) ?
+      UpdatePoly : 0;
+
+  if (LoadInst *li = dyn_cast<LoadInst>(v)) {
+    Value *ptr = li->getPointerOperand()->stripPointerCasts();
+    if (ptr == acc)
+      return UpdateSelf;
+    if (GEPOperator *gep = dyn_cast<GEPOperator>(ptr))
+      if (GlobalVariable *gv = dyn_cast<GlobalVariable>(
+            gep->getPointerOperand()->stripPointerCasts()))
+        if (gv->isConstant())
+          return UpdateTable;
+    return li->getType()->isIntegerTy(8) ? UpdateByte : 0;
+  }
+
+  Instruction *inst = dyn_cast<Instruction>(v);
+  if (!inst)
+    return 0;
+
+  unsigned features = 0;
+  if (BinaryOperator *bo = dyn_cast<BinaryOperator>(inst)) {
+    switch (bo->getOpcode()) {
+    case Instruction::Xor: features |= UpdateXor; break;
+    case Instruction::Add: features |= UpdateAdd; break;
+    case Instruction::Mul: features |= UpdateMul; break;
+    case Instruction::Shl:
+    case Instruction::LShr:
+    case Instruction::AShr: features |= UpdateShift; break;
+    case Instruction::URem:
+    case Instruction::SRem:
+      if (ConstantInt *ci = dyn_cast<ConstantInt>(bo->getOperand(1)))
+        if (ci->getBitWidth() <= 64 && isChecksumModulus(ci->getZExtValue()))
+          features |= UpdateModulus;
+      break;
+    default: break;
+    }
+  } else if (!isa<CastInst>(inst) && !isa<SelectInst>(inst) &&
+             !isa<PHINode>(inst)) {
+    return 0;
+  }
+
+  for (unsigned i = 0, e = inst->getNumOperands(); i != e; ++i)
+    features |= getUpdateFeatures(inst->getOperand(i), acc, depth - 1, visited);
+  return features;
+}
+
+static unsigned getUpdateFeatures(Value *v, Value *acc) {
+  std::set<Value*> visited;
+  return getUpdateFeatures(v, acc, 12, visited);
+}
+
+bool ChecksumBypassPass::runOnModule(Module &M) {
+  std::map<Location, std::vector<LoadInst*> > loads;
+  std::set<Location> derivedLocations;
+  std::set<Function*> derivedFunctions;
+  std::set<Value*> derived;
+  std::set<ICmpInst*> compares;
+  std::vector<Value*> worklist;
+
+  numBypassed = 0;
+
+  // Index the loads by location and seed the worklist with the
+  // accumulators of checksum loops.
+  std::vector<Location> seedLocations;
+  for (Module::iterator f = M.begin(), fe = M.end(); f != fe; ++f) {
+    for (Function::iterator b = f->begin(), be = f->end(); b != be; ++b) {
+      for (BasicBlock::iterator i = b->begin(), ie = b->end(); i != ie; ++i) {
+        Location loc;
+        if (LoadInst *li = dyn_cast<LoadInst>(i)) {
+          if (getLocation(li->getPointerOperand(), loc))
+            loads[loc].push_back(li);
+        } else if (PHINode *phi = dyn_cast<PHINode>(i)) {
+          if (!phi->getType()->isIntegerTy())
+            continue;
+          unsigned features = 0;
+          for (unsigned j = 0, e = phi->getNumIncomingValues(); j != e; ++j)
+            features |= getUpdateFeatures(phi->getIncomingValue(j), phi);
+          if (isChecksumUpdate(features))
+            worklist.push_back(phi);
+        } else if (AllocaInst *ai = dyn_cast<AllocaInst>(i)) {
+          if (!ai->getAllocatedType()->isIntegerTy())
+            continue;
+          unsigned features = 0;
+          for (Value::use_iterator ui = ai->use_begin(), ue = ai->use_end();
+               ui != ue; ++ui)
+            if (StoreInst *si = dyn_cast<StoreInst>(*ui))
+              if (si->getOperand(1) == ai)
+                features |= getUpdateFeatures(si->getOperand(0), ai);
+          if (isChecksumUpdate(features))
+            seedLocations.push_back(Location(ai, ""));
+        }
+      }
+    }
+  }
+
+  for (unsigned i = 0; i != seedLocations.size(); ++i) {
+    derivedLocations.insert(seedLocations[i]);
+    std::vector<LoadInst*> &l = loads[seedLocations[i]];
+    worklist.insert(worklist.end(), l.begin(), l.end());
+  }
+
+  // Follow the checksum values through arithmetic, memory locations and
+  // returns to the equality comparisons they end up in.
+  while (!worklist.empty()) {
+    Value *v = worklist.back();
+    worklist.pop_back();
+    if (!derived.insert(v).second)
+      continue;
+
+    for (Value::use_iterator ui = v->use_begin(), ue = v->use_end();
+         ui != ue; ++ui) {
+      User *u = *ui;
+      if (isa<CastInst>(u) || isa<BinaryOperator>(u) || isa<PHINode>(u)) {
+        worklist.push_back(u);
+      } else if (SelectInst *si = dyn_cast<SelectInst>(u)) {
+        if (si->getCondition() != v)
+          worklist.push_back(si);
+      } else if (StoreInst *si = dyn_cast<StoreInst>(u)) {
+        Location loc;
+        if (si->getOperand(0) == v &&
+            getLocation(si->getOperand(1), loc) &&
+            derivedLocations.insert(loc).second) {
+          std::vector<LoadInst*> &l = loads[loc];
+          worklist.insert(worklist.end(), l.begin(), l.end());
+        }
+      } else if (ReturnInst *ri = dyn_cast<ReturnInst>(u)) {
+        Function *f = ri->getParent()->getParent();
+        if (!derivedFunctions.insert(f).second)
+          continue;
+        for (Value::use_iterator fi = f->use_begin(), fe = f->use_end();
+             fi != fe; ++fi)
+          if (CallInst *ci = dyn_cast<CallInst>(*fi))
+            if (ci->getCalledFunction() == f)
+              worklist.push_back(ci);
+      } else if (ICmpInst *ci = dyn_cast<ICmpInst>(u)) {
+        if (ci->isEquality())
+          compares.insert(ci);
+      }
+    }
+  }
+
+  // Route each comparison of a checksum with a stored value through
+  // klee_checksum_match().
+  LLVM_TYPE_Q Type *i32Ty = Type::getInt32Ty(getGlobalContext());
+  LLVM_TYPE_Q Type *i64Ty = Type::getInt64Ty(getGlobalContext());
+  Function *matchFunction = 0;
+  for (std::set<ICmpInst*>::iterator it = compares.begin(),
+         ie = compares.end(); it != ie; ++it) {
+    ICmpInst *cmp = *it;
+    Value *computed = cmp->getOperand(0), *expected = cmp->getOperand(1);
+    if (!derived.count(computed))
+      std::swap(computed, expected);
+    if (isa<Constant>(expected) || !computed->getType()->isIntegerTy() ||
+        computed->getType()->getPrimitiveSizeInBits() > 64)
+      continue;
+
+    // Lazily bind the function to avoid always importing it.
+    if (!matchFunction) {
+      Constant *fc = M.getOrInsertFunction("klee_checksum_match",
+                                           i32Ty, i64Ty, i64Ty, NULL);
+      matchFunction = cast<Function>(fc);
+    }
+
+    std::vector<Value*> args;
+    args.push_back(CastInst::CreateIntegerCast(computed, i64Ty, false,
+                                               "checksum_computed", cmp));
+    args.push_back(CastInst::CreateIntegerCast(expected, i64Ty, false,
+                                               "checksum_expected", cmp));
+    CallInst *match =
+#if LLVM_VERSION_CODE >= LLVM_VERSION(3, 0)
+      CallInst::Create(matchFunction, args, "", cmp);
+#else
+      CallInst::Create(matchFunction, args.begin(), args.end(), "", cmp);
+#endif
+    match->setDebugLoc(cmp->getDebugLoc());
+
+    ICmpInst *result =
+      new ICmpInst(cmp, cmp->getPredicate() == ICmpInst::ICMP_EQ ?
+                   ICmpInst::ICMP_NE : ICmpInst::ICMP_EQ,
+                   match, ConstantInt::get(i32Ty, 0), "checksum_match");
+    result->setDebugLoc(cmp->getDebugLoc());
+    cmp->replaceAllUsesWith(result);
+    cmp->eraseFromParent();
+    ++numBypassed;
+  }
+
+  return numBypassed != 0;
+}
@@ -163,6 +163,11 @@ InstructionInfoTable::InstructionInfoTable(Module *m)
       }
     }
   }
+
+  infosByID.resize(id);
+  for (std::map<const Instruction*, InstructionInfo>::const_iterator
+         it = infos.begin(), ie = infos.end(); it != ie; ++it)
+    infosByID[it->second.id] = &it->second;
 }
 
 InstructionInfoTable::~InstructionInfoTable() {
@@ -198,6 +203,13 @@ InstructionInfoTable::getInfo(const Instruction *inst) const {
   }
 }
 
+const InstructionInfo &
+InstructionInfoTable::getInfoByID(unsigned id) const {
+  if (id >= infosByID.size())
+    return dummyInfo;
+  return *infosByID[id];
+}
+
 const InstructionInfo &
 InstructionInfoTable::getFunctionInfo(const Function *f) const {
   if (f->isDeclaration()) {
@@ -16,4 +16,5 @@ using namespace klee;
 
 KInstruction::~KInstruction() {
   delete[] operands;
+  delete[] successors;
 }
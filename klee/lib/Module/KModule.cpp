@@ -55,9 +55,6 @@
 
 #include <sstream>
 
-#define XQX_DEBUG_PATCH_CRCERROR 
-
-
 using namespace llvm;
 using namespace klee;
 
@@ -111,9 +108,9 @@ namespace {
                cl::init(false));
 
   cl::opt<bool>
-  PatchCrc("patch-crc",
-               cl::desc("patch crc check in libpng"),
-               cl::init(true));
+  BypassChecksums("bypass-checksums",
+                  cl::desc("Let symbolic checksum comparisons pass and fix up the checksums in generated tests (default=off)"),
+                  cl::init(false));
 
 
 }
@@ -362,6 +359,8 @@ void KModule::prepare(const Interpreter::ModuleOptions &opts,
   pm.add(new RaiseAsmPass());
   if (opts.CheckDivZero) pm.add(new DivCheckPass());
   if (opts.CheckOvershift) pm.add(new OvershiftCheckPass());
+  ChecksumBypassPass *checksumPass = 0;
+  if (BypassChecksums) pm.add(checksumPass = new ChecksumBypassPass());
 
   //add a pass to get the path before run klee
   //pm.add(new CallPathsPass());
@@ -375,6 +374,9 @@ void KModule::prepare(const Interpreter::ModuleOptions &opts,
   // issue.
   pm.add(new IntrinsicCleanerPass(*targetData, false));
   pm.run(*module);
+  if (checksumPass && checksumPass->numBypassed)
+    klee_message("bypassing %u checksum comparisons",
+                 checksumPass->numBypassed);
 
   if (opts.Optimize)
     Optimize(module);
@@ -636,49 +638,6 @@ void KModule::prepare(const Interpreter::ModuleOptions &opts,
     llvm::errs() << "]\n";
   }
   
-#ifdef XQX_DEBUG_PATCH_CRCERROR
-  //addbyxqx
-  if(PatchCrc){
-  if (OutputSource) {
-    std::ostream *os = ih->openOutputFile("patched.ll");
-    assert(os && os->good() && "unable to open source output");
-
-    llvm::raw_os_ostream *ros = new llvm::raw_os_ostream(*os);
-
-    // We have an option for this in case the user wants a .ll they
-    // can compile.
-    if (NoTruncateSourceLines) {
-      *ros << *module;
-    } else {
-      std::string string;
-      llvm::raw_string_ostream rss(string);
-      rss << *module;
-      rss.flush();
-      const char *position = string.c_str();
-
-      for (;;) {
-        const char *end = index(position, '\n');
-        if (!end) {
-          *ros << position;
-          break;
-        } else {
-          unsigned count = (end - position) + 1;
-          if (count<255) {
-            ros->write(position, count);
-          } else {
-            ros->write(position, 254);
-            *ros << "\n";
-          }
-          position = end+1;
-        }
-      }
-    }
-    delete ros;
-
-    delete os;
-  }
-  }
-#endif
 }
 
 KConstant* KModule::getKConstant(Constant *c) {
@@ -764,21 +723,6 @@ KFunction::KFunction(llvm::Function *_function,
   }
   numRegisters = rnum;
   
-#ifdef XQX_DEBUG_PATCH_CRCERROR
-  bool in_crcerror = false;
-  bool in_png_calc_crc = false;
-  if(PatchCrc){
-  if( function->getNameStr() == "png_crc_error" ) {
-	  klee_xqx_debug("kfunction----%s", function->getName());
-	  in_crcerror = true;
-  }
-  if( function->getNameStr() == "png_calculate_crc" ) {
-	  klee_xqx_debug("kfunction----%s", function->getName());
-	  in_png_calc_crc = true;
-  }
-  }
-#endif
-
   unsigned i = 0;
   for (llvm::Function::iterator bbit = function->begin(), 
          bbie = function->end(); bbit != bbie; ++bbit) {
@@ -801,47 +745,18 @@ KFunction::KFunction(llvm::Function *_function,
 
       ki->inst = it;      
       ki->dest = registerMap[it];
-#ifdef XQX_DEBUG_PATCH_CRCERROR
-  if(PatchCrc){
-	  if( in_crcerror ) {
-		  if( PHINode *phi = dyn_cast<PHINode>(it) ){
-			  it->dump();
-			  //unsigned numOperands = it->getNumOperands();
-			  //for (unsigned j=0; j<numOperands; j++) {
-				  //Value *v = it->getOperand(j);
-				  //v->dump();
-			  //}
-			  it->setOperand(0,it->getOperand(2));
-			  it->dump();
-		  }
-		  // if add "-g" 
-		  if( StoreInst *SI = dyn_cast<StoreInst>(it) ) {
-			  //klee_message("store in %s by ", SI->getOperand(1)->getName().str().c_str());
-			  if( SI->getOperand(1)->getName().str() == "need_crc") {
-				  if( ConstantInt *CI = dyn_cast<ConstantInt>(SI->getOperand(0)) ) {
-					  if( CI->isOne() ) 
-						  SI->setOperand(0,llvm::ConstantInt::get(SI->getOperand(0)->getType(), 0) );
-				  }
-			  }
-		  }
-
-	  }
-	  if( in_png_calc_crc ) {
-		  if( BranchInst *BrI = dyn_cast<BranchInst>(it) ) {
-			  //klee_message("br: succ0:%s", BrI->getSuccessor(0)->getName().str().c_str());
-			  //klee_message("br: succ1:%s", BrI->getSuccessor(1)->getName().str().c_str());
-			  if ( BrI->getParent()->getNameStr() == "bb" ) {
-				  BrI->setCondition(llvm::ConstantInt::get(BrI->getCondition()->getType(),1) );
-
-			  }
-			  //1.4.2 :0   1.7.0 :1
-			  if ( BrI->getParent()->getNameStr() == "bb2" ) 
-				  BrI->setCondition(llvm::ConstantInt::get(BrI->getCondition()->getType(),1) );
-		  }
-	  }
-  }
-#endif
-
+      ki->opcode = it->getOpcode();
+      ki->width = it->getType()->isSized() ?
+        km->targetData->getTypeSizeInBits(it->getType()) : 0;
+      ki->successors = 0;
+      if (TerminatorInst *ti = dyn_cast<TerminatorInst>(it)) {
+        unsigned numSuccessors = ti->getNumSuccessors();
+        if (numSuccessors) {
+          ki->successors = new unsigned[numSuccessors];
+          for (unsigned j=0; j<numSuccessors; j++)
+            ki->successors[j] = basicBlockEntry[ti->getSuccessor(j)];
+        }
+      }
 
       if (isa<CallInst>(it) || isa<InvokeInst>(it)) {
         CallSite cs(it);
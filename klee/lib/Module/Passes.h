@@ -181,6 +181,24 @@ public:
   virtual bool runOnModule(llvm::Module &M);
 };
 
+/// ChecksumBypassPass - Find the accumulators of checksum loops
+/// (table-driven and bitwise CRCs, Adler/Fletcher sums and plain byte
+/// sums), follow their values through registers, memory and returns,
+/// and route every equality comparison of a checksum against a stored
+/// value through klee_checksum_match().
+///
+/// At run time a symbolic comparison is assumed to match, and the
+/// stored value is fixed up in the generated test instead.
+class ChecksumBypassPass : public llvm::ModulePass {
+  static char ID;
+public:
+  /// Number of comparisons rewritten by the last run.
+  unsigned numBypassed;
+
+  ChecksumBypassPass(): ModulePass(ID), numBypassed(0) {}
+  virtual bool runOnModule(llvm::Module &M);
+};
+
 /// LowerSwitchPass - Replace all SwitchInst instructions with chained branch
 /// instructions.  Note that this cannot be a BasicBlock pass because it
 /// modifies the CFG!
@@ -63,12 +63,17 @@ private:
                                   IncompleteSolver::PartialValidity, 
                                   CacheEntryHash> cache_map;
   
+  typedef std::tr1::unordered_map<CacheEntry, 
+                                  std::pair<uint64_t, uint64_t>,
+                                  CacheEntryHash> range_cache_map;
+  
   Solver *solver;
   cache_map cache;
+  range_cache_map rangeCache;
 
 public:
   CachingSolver(Solver *s) : solver(s) {}
-  ~CachingSolver() { cache.clear(); delete solver; }
+  ~CachingSolver() { cache.clear(); rangeCache.clear(); delete solver; }
 
   bool computeValidity(const Query&, Solver::Validity &result);
   bool computeTruth(const Query&, bool &isValid);
@@ -76,6 +81,10 @@ public:
     ++stats::queryCacheMisses;
     return solver->impl->computeValue(query, result);
   }
+  bool computeFeasibility(const ConstraintManager &constraints,
+                          const std::vector< ref<Expr> > &exprs,
+                          std::vector<bool> &results);
+  bool computeRange(const Query&, uint64_t &min, uint64_t &max);
   bool computeInitialValues(const Query& query,
                             const std::vector<const Array*> &objects,
                             std::vector< std::vector<unsigned char> > &values,
@@ -242,6 +251,81 @@ bool CachingSolver::computeTruth(const Query& query,
   return true;
 }
 
+bool CachingSolver::computeFeasibility(const ConstraintManager &constraints,
+                                       const std::vector< ref<Expr> > &exprs,
+                                       std::vector<bool> &results) {
+  results.resize(exprs.size());
+
+  // An expression may be true iff its negation is not valid, so look
+  // up the negated queries and pass only the misses on as one batch.
+  std::vector< ref<Expr> > misses;
+  std::vector<unsigned> missIndex;
+  std::vector<bool> missKnownTrue;
+  for (unsigned i = 0, e = exprs.size(); i != e; ++i) {
+    Query query(constraints, Expr::createIsZero(exprs[i]));
+    IncompleteSolver::PartialValidity cachedResult;
+    bool cacheHit = cacheLookup(query, cachedResult);
+
+    // a cached result of MayBeTrue forces us to check whether
+    // a False assignment exists.
+    if (cacheHit && cachedResult != IncompleteSolver::MayBeTrue) {
+      ++stats::queryCacheHits;
+      results[i] = (cachedResult != IncompleteSolver::MustBeTrue);
+      continue;
+    }
+
+    ++stats::queryCacheMisses;
+    misses.push_back(exprs[i]);
+    missIndex.push_back(i);
+    missKnownTrue.push_back(cacheHit);
+  }
+
+  if (misses.empty())
+    return true;
+
+  std::vector<bool> missResults;
+  if (!solver->impl->computeFeasibility(constraints, misses, missResults))
+    return false;
+
+  for (unsigned i = 0, e = misses.size(); i != e; ++i) {
+    IncompleteSolver::PartialValidity cachedResult;
+    if (!missResults[i]) {
+      cachedResult = IncompleteSolver::MustBeTrue;
+    } else if (missKnownTrue[i]) {
+      cachedResult = IncompleteSolver::TrueOrFalse;
+    } else {
+      cachedResult = IncompleteSolver::MayBeFalse;
+    }
+
+    cacheInsert(Query(constraints, Expr::createIsZero(misses[i])), 
+                cachedResult);
+    results[missIndex[i]] = missResults[i];
+  }
+
+  return true;
+}
+
+bool CachingSolver::computeRange(const Query& query,
+                                 uint64_t &min, uint64_t &max) {
+  CacheEntry ce(query.constraints, query.expr);
+  range_cache_map::iterator it = rangeCache.find(ce);
+
+  if (it != rangeCache.end()) {
+    ++stats::rangeCacheHits;
+    min = it->second.first;
+    max = it->second.second;
+    return true;
+  }
+
+  ++stats::rangeCacheMisses;
+
+  if (!solver->impl->computeRange(query, min, max))
+    return false;
+
+  rangeCache.insert(std::make_pair(ce, std::make_pair(min, max)));
+  return true;
+}
+
 SolverImpl::SolverRunStatus CachingSolver::getOperationStatusCode() {
   return solver->impl->getOperationStatusCode();
 }
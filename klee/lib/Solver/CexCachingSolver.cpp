@@ -78,6 +78,12 @@ public:
   bool computeTruth(const Query&, bool &isValid);
   bool computeValidity(const Query&, Solver::Validity &result);
   bool computeValue(const Query&, ref<Expr> &result);
+  bool computeFeasibility(const ConstraintManager &constraints,
+                          const std::vector< ref<Expr> > &exprs,
+                          std::vector<bool> &results);
+  bool computeRange(const Query& query, uint64_t &min, uint64_t &max) {
+    return solver->impl->computeRange(query, min, max);
+  }
   bool computeInitialValues(const Query&,
                             const std::vector<const Array*> &objects,
                             std::vector< std::vector<unsigned char> > &values,
@@ -315,6 +321,53 @@ bool CexCachingSolver::computeValue(const Query& query,
   return true;
 }
 
+bool 
+CexCachingSolver::computeFeasibility(const ConstraintManager &constraints,
+                                     const std::vector< ref<Expr> > &exprs,
+                                     std::vector<bool> &results) {
+  TimerStatIncrementer t(stats::cexCacheTime);
+
+  results.resize(exprs.size());
+
+  // An expression may be true iff there is an assignment for the
+  // constraints together with it; answer what the cache knows and send
+  // the rest down in one batch.
+  std::vector< ref<Expr> > misses;
+  std::vector<unsigned> missIndex;
+  std::vector<KeyType> missKeys;
+  for (unsigned i = 0, e = exprs.size(); i != e; ++i) {
+    KeyType key;
+    Assignment *a;
+    if (lookupAssignment(Query(constraints, Expr::createIsZero(exprs[i])), 
+                         key, a)) {
+      results[i] = (a != 0);
+      continue;
+    }
+
+    misses.push_back(exprs[i]);
+    missIndex.push_back(i);
+    missKeys.push_back(key);
+  }
+
+  if (misses.empty())
+    return true;
+
+  std::vector<bool> missResults;
+  if (!solver->impl->computeFeasibility(constraints, misses, missResults))
+    return false;
+
+  for (unsigned i = 0, e = misses.size(); i != e; ++i) {
+    results[missIndex[i]] = missResults[i];
+
+    // Only unsatisfiability can be memoized, feasible answers come
+    // without an assignment.
+    if (!missResults[i])
+      cache.insert(missKeys[i], (Assignment*) 0);
+  }
+
+  return true;
+}
+
 bool 
 CexCachingSolver::computeInitialValues(const Query& query,
                                        const std::vector<const Array*> 
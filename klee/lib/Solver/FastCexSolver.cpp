@@ -350,7 +350,7 @@ public:
     if (array.isConstantArray() && 
         index.isFixed() && 
         index.min() < array.size)
-      return ValueRange(array.constantValues[index.min()]->getZExtValue(8));
+      return ValueRange(array.getConstantValue(index.min()));
 
     return ValueRange(0, 255);
   }
@@ -816,7 +816,7 @@ public:
       if (index.isFixed()) {
         if (array->isConstantArray()) {
           // Verify the range.
-          propogateExactValues(array->constantValues[index.min()],
+          propogateExactValues(array->getConstantExpr(index.min()),
                                range);
         } else {
           CexValueData cvd = cod.getExactValues(index.min());
@@ -121,6 +121,50 @@ bool StagedSolverImpl::computeValue(const Query& query,
   return secondary->impl->computeValue(query, result);
 }
 
+bool 
+StagedSolverImpl::computeFeasibility(const ConstraintManager &constraints,
+                                     const std::vector< ref<Expr> > &exprs,
+                                     std::vector<bool> &results) {
+  results.resize(exprs.size());
+
+  std::vector< ref<Expr> > unknown;
+  std::vector<unsigned> unknownIndex;
+  for (unsigned i = 0, e = exprs.size(); i != e; ++i) {
+    switch (primary->computeTruth(Query(constraints, 
+                                        Expr::createIsZero(exprs[i])))) {
+    case IncompleteSolver::MustBeTrue:
+      results[i] = false;
+      break;
+    case IncompleteSolver::MustBeFalse:
+    case IncompleteSolver::MayBeFalse:
+    case IncompleteSolver::TrueOrFalse:
+      results[i] = true;
+      break;
+    default:
+      unknown.push_back(exprs[i]);
+      unknownIndex.push_back(i);
+      break;
+    }
+  }
+
+  if (unknown.empty())
+    return true;
+
+  std::vector<bool> unknownResults;
+  if (!secondary->impl->computeFeasibility(constraints, unknown, 
+                                           unknownResults))
+    return false;
+
+  for (unsigned i = 0, e = unknown.size(); i != e; ++i)
+    results[unknownIndex[i]] = unknownResults[i];
+  return true;
+}
+
+bool StagedSolverImpl::computeRange(const Query& query,
+                                    uint64_t &min, uint64_t &max) {
+  return secondary->impl->computeRange(query, min, max);
+}
+
 bool 
 StagedSolverImpl::computeInitialValues(const Query& query,
                                        const std::vector<const Array*> 
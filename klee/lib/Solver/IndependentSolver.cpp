@@ -16,6 +16,7 @@
 #include "klee/util/ExprUtil.h"
 
 #include <map>
+#include <set>
 #include <vector>
 #include <ostream>
 #include <iostream>
@@ -277,6 +278,10 @@ public:
   bool computeTruth(const Query&, bool &isValid);
   bool computeValidity(const Query&, Solver::Validity &result);
   bool computeValue(const Query&, ref<Expr> &result);
+  bool computeFeasibility(const ConstraintManager &constraints,
+                          const std::vector< ref<Expr> > &exprs,
+                          std::vector<bool> &results);
+  bool computeRange(const Query&, uint64_t &min, uint64_t &max);
   bool computeInitialValues(const Query& query,
                             const std::vector<const Array*> &objects,
                             std::vector< std::vector<unsigned char> > &values,
@@ -316,6 +321,38 @@ bool IndependentSolver::computeValue(const Query& query, ref<Expr> &result) {
   return solver->impl->computeValue(Query(tmp, query.expr), result);
 }
 
+bool IndependentSolver::computeFeasibility(const ConstraintManager &constraints,
+                                           const std::vector< ref<Expr> > &exprs,
+                                           std::vector<bool> &results) {
+  // The expressions are answered together, so keep every constraint
+  // that any of them depends on (in the original order).
+  std::set< ref<Expr> > requiredSet;
+  for (std::vector< ref<Expr> >::const_iterator it = exprs.begin(),
+         ie = exprs.end(); it != ie; ++it) {
+    std::vector< ref<Expr> > required;
+    getIndependentConstraints(Query(constraints, *it), required);
+    requiredSet.insert(required.begin(), required.end());
+  }
+
+  std::vector< ref<Expr> > required;
+  for (ConstraintManager::const_iterator it = constraints.begin(), 
+         ie = constraints.end(); it != ie; ++it)
+    if (requiredSet.count(*it))
+      required.push_back(*it);
+
+  ConstraintManager tmp(required);
+  return solver->impl->computeFeasibility(tmp, exprs, results);
+}
+
+bool IndependentSolver::computeRange(const Query& query,
+                                     uint64_t &min, uint64_t &max) {
+  std::vector< ref<Expr> > required;
+  IndependentElementSet eltsClosure = 
+    getIndependentConstraints(query, required);
+  ConstraintManager tmp(required);
+  return solver->impl->computeRange(Query(tmp, query.expr), min, max);
+}
+
 SolverImpl::SolverRunStatus IndependentSolver::getOperationStatusCode() {
   return solver->impl->getOperationStatusCode();      
 }
@@ -195,7 +195,7 @@ typename SolverContext::result_type MetaSMTBuilder<SolverContext>::getInitialArr
                             evaluate(_solver, 
                                      metaSMT::logic::Array::store(array_expr,
                                                                   construct(ConstantExpr::alloc(i, root->getDomain()), 0),
-                                                                  construct(root->constantValues[i], 0)));
+                                                                  construct(root->getConstantExpr(i), 0)));
                 array_expr = tmp;
             }
         }
@@ -19,6 +19,7 @@
 #include "llvm/Support/CommandLine.h"
 
 #include <cstdio>
+#include <cstring>
 
 #define vc_bvBoolExtract IAMTHESPAWNOFSATAN
 // unclear return
@@ -425,11 +426,43 @@ ExprHandle STPBuilder::constructSDivByConstant(ExprHandle expr_n, unsigned width
   return res;
 }
 
+unsigned 
+STPBuilder::ConstantArrayHashFn::operator()(const Array *array) const {
+  unsigned res = array->size;
+  const uint8_t *bytes = array->contents->data();
+  for (unsigned i = 0, e = array->size; i != e; ++i)
+    res = (res * Expr::MAGIC_HASH_CONSTANT) + bytes[i];
+  return res;
+}
+
+bool STPBuilder::ConstantArrayCmpFn::operator()(const Array *a,
+                                                const Array *b) const {
+  if (a == b || a->contents.get() == b->contents.get())
+    return true;
+  if (a->size != b->size)
+    return false;
+  return memcmp(a->contents->data(), b->contents->data(), a->size) == 0;
+}
+
 ::VCExpr STPBuilder::getInitialArray(const Array *root) {
   
   assert(root);
   ::VCExpr array_expr;
   bool hashed = _arr_hash.lookupArrayExpr(root, array_expr);
+
+  // Every flush of a concrete object creates a new constant array, so
+  // reuse the STP array of an earlier one with the same contents
+  // instead of encoding all the bytes again.
+  if (!hashed && root->isConstantArray()) {
+    std::tr1::unordered_map<const Array*, ::VCExpr, ConstantArrayHashFn,
+                            ConstantArrayCmpFn>::iterator it = 
+      constantArrays.find(root);
+    if (it != constantArrays.end()) {
+      array_expr = it->second;
+      _arr_hash.hashArrayExpr(root, array_expr);
+      hashed = true;
+    }
+  }
   
   if (!hashed) {
     // STP uniques arrays by name, so we make sure the name is unique by
@@ -449,10 +482,12 @@ ExprHandle STPBuilder::constructSDivByConstant(ExprHandle expr_n, unsigned width
       for (unsigned i = 0, e = root->size; i != e; ++i) {
 	::VCExpr prev = array_expr;
 	array_expr = vc_writeExpr(vc, prev,
-                       construct(ConstantExpr::alloc(i, root->getDomain()), 0),
-                       construct(root->constantValues[i], 0));
+                       bvConst32(root->getDomain(), i),
+                       bvConst32(root->getRange(),
+                                 root->getConstantValue(i)));
 	vc_DeleteExpr(prev);
       }
+      constantArrays.insert(std::make_pair(root, array_expr));
     }
     
     _arr_hash.hashArrayExpr(root, array_expr);
@@ -558,6 +593,26 @@ ExprHandle STPBuilder::constructActual(ref<Expr> e, int *width_out) {
     ReadExpr *re = cast<ReadExpr>(e);
     //re->dump();
     *width_out = 8;
+
+    // A read at a concrete index can be answered from the concrete
+    // writes and the constant initial contents without building the
+    // array at all.
+    if (ConstantExpr *CE = dyn_cast<ConstantExpr>(re->index)) {
+      uint64_t index = CE->getZExtValue();
+      const UpdateNode *un = re->updates.head;
+      for (; un; un = un->next) {
+        ConstantExpr *UI = dyn_cast<ConstantExpr>(un->index);
+        if (!UI)
+          break;
+        if (UI->getZExtValue() == index)
+          return construct(un->value, width_out);
+      }
+
+      const Array *root = re->updates.root;
+      if (!un && root->isConstantArray() && index < root->size)
+        return bvConst32(8, root->getConstantValue(index));
+    }
+
     return vc_readExpr(vc,
                        getArrayForUpdate(re->updates.root, re->updates.head),
                        construct(re->index, 0));
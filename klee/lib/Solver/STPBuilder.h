@@ -15,6 +15,7 @@
 #include "klee/Config/config.h"
 
 #include <vector>
+#include <tr1/unordered_map>
 
 #define Expr VCExpr
 #include <stp/c_interface.h>
@@ -78,6 +79,20 @@ class STPBuilder {
 
   STPArrayExprHash _arr_hash;
 
+  /// Hash and compare constant arrays by their contents, so that
+  /// separate snapshots of the same concrete bytes share one STP array.
+  struct ConstantArrayHashFn {
+    unsigned operator()(const Array *array) const;
+  };
+  struct ConstantArrayCmpFn {
+    bool operator()(const Array *a, const Array *b) const;
+  };
+
+  /// constantArrays - The STP array built for each distinct constant
+  /// array contents, kept for the lifetime of the builder.
+  std::tr1::unordered_map<const Array*, ::VCExpr, ConstantArrayHashFn,
+                          ConstantArrayCmpFn> constantArrays;
+
 private:  
   unsigned getShiftBits(unsigned amount) {
     unsigned bits = 1;
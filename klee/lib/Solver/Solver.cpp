@@ -27,6 +27,7 @@
 
 #include <cassert>
 #include <cstdio>
+#include <cstring>
 #include <map>
 #include <vector>
 
@@ -85,6 +86,20 @@ bool SolverImpl::computeValidity(const Query& query, Solver::Validity &result) {
   return true;
 }
 
+bool SolverImpl::computeFeasibility(const ConstraintManager &constraints,
+                                    const std::vector< ref<Expr> > &exprs,
+                                    std::vector<bool> &results) {
+  results.resize(exprs.size());
+  for (unsigned i = 0, e = exprs.size(); i != e; ++i) {
+    bool isValid;
+    if (!computeTruth(Query(constraints, Expr::createIsZero(exprs[i])), 
+                      isValid))
+      return false;
+    results[i] = !isValid;
+  }
+  return true;
+}
+
 const char* SolverImpl::getOperationStatusString(SolverRunStatus statusCode)
 {
     switch (statusCode)
@@ -174,6 +189,36 @@ bool Solver::mayBeFalse(const Query& query, bool &result) {
   return true;
 }
 
+bool Solver::mayBeTrue(const ConstraintManager &constraints,
+                       const std::vector< ref<Expr> > &exprs,
+                       std::vector<bool> &results) {
+  results.resize(exprs.size());
+
+  // Maintain invariants implementations expect.
+  std::vector< ref<Expr> > pending;
+  std::vector<unsigned> pendingIndex;
+  for (unsigned i = 0, e = exprs.size(); i != e; ++i) {
+    assert(exprs[i]->getWidth() == Expr::Bool && "Invalid expression type!");
+    if (ConstantExpr *CE = dyn_cast<ConstantExpr>(exprs[i])) {
+      results[i] = CE->isTrue();
+    } else {
+      pending.push_back(exprs[i]);
+      pendingIndex.push_back(i);
+    }
+  }
+
+  if (pending.empty())
+    return true;
+
+  std::vector<bool> pendingResults;
+  if (!impl->computeFeasibility(constraints, pending, pendingResults))
+    return false;
+
+  for (unsigned i = 0, e = pending.size(); i != e; ++i)
+    results[pendingIndex[i]] = pendingResults[i];
+  return true;
+}
+
 bool Solver::getValue(const Query& query, ref<ConstantExpr> &result) {
   // Maintain invariants implementation expect.
   if (ConstantExpr *CE = dyn_cast<ConstantExpr>(query.expr)) {
@@ -204,6 +249,19 @@ Solver::getInitialValues(const Query& query,
   return success;
 }
 
+bool Solver::getRange(const Query& query, uint64_t &min, uint64_t &max) {
+  ref<Expr> e = query.expr;
+  if (ConstantExpr *CE = dyn_cast<ConstantExpr>(e)) {
+    if (CE->getWidth() > 64)
+      return false;
+    min = max = CE->getZExtValue();
+    return true;
+  }
+  if (e->getWidth() == Expr::Bool || e->getWidth() > 64)
+    return false;
+  return impl->computeRange(query, min, max);
+}
+
 std::pair< ref<Expr>, ref<Expr> > Solver::getRange(const Query& query) {
   ref<Expr> e = query.expr;
   Expr::Width width = e->getWidth();
@@ -223,6 +281,8 @@ std::pair< ref<Expr>, ref<Expr> > Solver::getRange(const Query& query) {
     }
   } else if (ConstantExpr *CE = dyn_cast<ConstantExpr>(e)) {
     min = max = CE->getZExtValue();
+  } else if (width <= 64 && impl->computeRange(query, min, max)) {
+    // The implementation decided the whole range in a single context.
   } else {
     // binary search for # of useful bits
     uint64_t lo=0, hi=width, mid, bits=0;
@@ -511,6 +571,10 @@ public:
 
   bool computeTruth(const Query&, bool &isValid);
   bool computeValue(const Query&, ref<Expr> &result);
+  bool computeFeasibility(const ConstraintManager &constraints,
+                          const std::vector< ref<Expr> > &exprs,
+                          std::vector<bool> &results);
+  bool computeRange(const Query&, uint64_t &min, uint64_t &max);
   bool computeInitialValues(const Query&,
                             const std::vector<const Array*> &objects,
                             std::vector< std::vector<unsigned char> > &values,
@@ -831,6 +895,242 @@ STPSolverImpl::computeInitialValues(const Query &query,
   return success;
 }
 
+/// Run body(arg) in a child process, so that it can be interrupted by
+/// the solver timeout, and wait for it. The body passes its results
+/// back through shared_memory_ptr, and returns false if STP failed.
+static SolverImpl::SolverRunStatus runInForkedProcess(bool (*body)(void*),
+                                                      void *arg,
+                                                      double timeout) {
+  fflush(stdout);
+  fflush(stderr);
+  int pid = fork();
+  if (pid==-1) {
+    fprintf(stderr, "ERROR: fork failed (for STP)");
+    if (!IgnoreSolverFailures) 
+      exit(1);
+    return SolverImpl::SOLVER_RUN_STATUS_FORK_FAILED;
+  }
+
+  if (pid == 0) {
+    if (timeout) {      
+      ::alarm(0); /* Turn off alarm so we can safely set signal handler */
+      ::signal(SIGALRM, stpTimeoutHandler);
+      ::alarm(std::max(1, (int)timeout));
+    }    
+    _exit(body(arg) ? 0 : 2);
+  }
+
+  int status;
+  pid_t res;
+
+  do {
+    res = waitpid(pid, &status, 0);
+  } while (res < 0 && errno == EINTR);
+    
+  if (res < 0) {
+    fprintf(stderr, "ERROR: waitpid() for STP failed");
+    if (!IgnoreSolverFailures) 
+      exit(1);
+    return SolverImpl::SOLVER_RUN_STATUS_WAITPID_FAILED;
+  }
+    
+  if (WIFSIGNALED(status) || !WIFEXITED(status)) {
+    fprintf(stderr, "ERROR: STP did not return successfully.  Most likely you forgot to run 'ulimit -s unlimited'\n");
+    if (!IgnoreSolverFailures)
+      exit(1);
+    return SolverImpl::SOLVER_RUN_STATUS_INTERRUPTED;
+  }
+
+  int exitcode = WEXITSTATUS(status);
+  if (exitcode==52) {
+    fprintf(stderr, "error: STP timed out");
+    return SolverImpl::SOLVER_RUN_STATUS_TIMEOUT;
+  } else if (exitcode!=0) {
+    fprintf(stderr, "error: STP did not return a recognized code");
+    if (!IgnoreSolverFailures) 
+      exit(1);
+    return SolverImpl::SOLVER_RUN_STATUS_UNEXPECTED_EXIT_CODE;
+  }
+
+  return SolverImpl::SOLVER_RUN_STATUS_SUCCESS_SOLVABLE;
+}
+
+/// Check each of queries for validity against the formulas currently
+/// asserted in vc, recording in feasible whether its negation has a
+/// solution. Return false if STP fails on any of them.
+static bool runFeasibility(::VC vc, std::vector<ExprHandle> &queries,
+                           unsigned char *feasible) {
+  for (unsigned i = 0, e = queries.size(); i != e; ++i) {
+    vc_push(vc);
+    int res = vc_query(vc, queries[i]);
+    vc_pop(vc);
+    if (res != 0 && res != 1)
+      return false;
+    feasible[i] = (res == 0);
+  }
+  return true;
+}
+
+struct FeasibilityJob {
+  ::VC vc;
+  std::vector<ExprHandle> *queries;
+};
+
+static bool runFeasibilityJob(void *arg) {
+  FeasibilityJob *job = static_cast<FeasibilityJob*>(arg);
+  return runFeasibility(job->vc, *job->queries, shared_memory_ptr);
+}
+
+/// Decide the bits of expr from the most significant one down, keeping
+/// each bit at preferOne whenever that is still feasible, and set value
+/// to the resulting extreme. Every decision is asserted before the next
+/// bit is tried, so the whole search shares one context. Return false
+/// if STP fails.
+static bool runRangeBound(::VC vc, ExprHandle expr, unsigned width,
+                          bool preferOne, uint64_t &value) {
+  bool success = true;
+  value = 0;
+
+  vc_push(vc);
+  for (int bit = width - 1; bit >= 0; --bit) {
+    ExprHandle isOne = vc_eqExpr(vc, vc_bvExtract(vc, expr, bit, bit),
+                                 vc_bvConstExprFromInt(vc, 1, 1));
+    ExprHandle isZero = vc_notExpr(vc, isOne);
+
+    vc_push(vc);
+    int res = vc_query(vc, preferOne ? isZero : isOne);
+    vc_pop(vc);
+    if (res != 0 && res != 1) {
+      success = false;
+      break;
+    }
+
+    bool one = ((res == 0) == preferOne);
+    if (one)
+      value |= (uint64_t) 1 << bit;
+    vc_assertFormula(vc, one ? isOne : isZero);
+  }
+  vc_pop(vc);
+
+  return success;
+}
+
+struct RangeJob {
+  ::VC vc;
+  ExprHandle expr;
+  unsigned width;
+};
+
+static bool runRangeJob(void *arg) {
+  RangeJob *job = static_cast<RangeJob*>(arg);
+  uint64_t bounds[2];
+  if (!runRangeBound(job->vc, job->expr, job->width, false, bounds[0]) ||
+      !runRangeBound(job->vc, job->expr, job->width, true, bounds[1]))
+    return false;
+  memcpy(shared_memory_ptr, bounds, sizeof(bounds));
+  return true;
+}
+
+bool STPSolverImpl::computeRange(const Query &query,
+                                 uint64_t &min, uint64_t &max) {
+  runStatusCode = SOLVER_RUN_STATUS_FAILURE; 
+
+  TimerStatIncrementer t(stats::queryTime);
+
+  vc_push(vc);
+
+  for (ConstraintManager::const_iterator it = query.constraints.begin(), 
+         ie = query.constraints.end(); it != ie; ++it)
+    vc_assertFormula(vc, builder->construct(*it));
+
+  unsigned width = query.expr->getWidth();
+  ExprHandle expr = builder->construct(query.expr);
+
+  // One feasibility check per bit for each bound.
+  stats::queries += 2 * width;
+  ++stats::rangeQueries;
+
+  bool success;
+  if (useForkedSTP) {
+    RangeJob job = { vc, expr, width };
+    runStatusCode = runInForkedProcess(runRangeJob, &job, timeout);
+    success = (SOLVER_RUN_STATUS_SUCCESS_SOLVABLE == runStatusCode);
+    if (success) {
+      uint64_t bounds[2];
+      memcpy(bounds, shared_memory_ptr, sizeof(bounds));
+      min = bounds[0];
+      max = bounds[1];
+    }
+  } else {
+    success = runRangeBound(vc, expr, width, false, min) &&
+              runRangeBound(vc, expr, width, true, max);
+    runStatusCode = success ? SOLVER_RUN_STATUS_SUCCESS_SOLVABLE :
+                              SOLVER_RUN_STATUS_FAILURE;
+  }
+
+  vc_pop(vc);
+
+  return success;
+}
+
+bool
+STPSolverImpl::computeFeasibility(const ConstraintManager &constraints,
+                                  const std::vector< ref<Expr> > &exprs,
+                                  std::vector<bool> &results) {
+  runStatusCode = SOLVER_RUN_STATUS_FAILURE; 
+
+  TimerStatIncrementer t(stats::queryTime);
+
+  // Assert the constraints once and check each expression in its own
+  // context on top of them.
+  vc_push(vc);
+
+  for (ConstraintManager::const_iterator it = constraints.begin(), 
+         ie = constraints.end(); it != ie; ++it)
+    vc_assertFormula(vc, builder->construct(*it));
+
+  std::vector<ExprHandle> queries;
+  queries.reserve(exprs.size());
+  for (std::vector< ref<Expr> >::const_iterator it = exprs.begin(),
+         ie = exprs.end(); it != ie; ++it)
+    queries.push_back(builder->construct(Expr::createIsZero(*it)));
+
+  stats::queries += exprs.size();
+
+  std::vector<unsigned char> feasible;
+  bool success;
+  if (useForkedSTP) {
+    assert(queries.size() < shared_memory_size &&
+           "not enough shared memory for feasibility results");
+    FeasibilityJob job = { vc, &queries };
+    runStatusCode = runInForkedProcess(runFeasibilityJob, &job, timeout);
+    success = (SOLVER_RUN_STATUS_SUCCESS_SOLVABLE == runStatusCode);
+    if (success)
+      feasible.assign(shared_memory_ptr, shared_memory_ptr + queries.size());
+  } else {
+    feasible.resize(queries.size());
+    success = runFeasibility(vc, queries, &feasible[0]);
+    runStatusCode = success ? SOLVER_RUN_STATUS_SUCCESS_SOLVABLE :
+                              SOLVER_RUN_STATUS_FAILURE;
+  }
+
+  vc_pop(vc);
+
+  if (!success)
+    return false;
+
+  results.resize(exprs.size());
+  for (unsigned i = 0, e = exprs.size(); i != e; ++i) {
+    results[i] = feasible[i];
+    if (feasible[i])
+      ++stats::queriesInvalid;
+    else
+      ++stats::queriesValid;
+  }
+
+  return true;
+}
+
 SolverImpl::SolverRunStatus STPSolverImpl::getOperationStatusCode() {
    return runStatusCode;
 }
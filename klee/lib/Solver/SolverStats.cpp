@@ -23,6 +23,9 @@ Statistic stats::queryConstructTime("QueryConstructTime", "QBtime") ;
 Statistic stats::queryConstructs("QueriesConstructs", "QB");
 Statistic stats::queryCounterexamples("QueriesCEX", "Qcex");
 Statistic stats::queryTime("QueryTime", "Qtime");
+Statistic stats::rangeCacheHits("RangeCacheHits", "RChits");
+Statistic stats::rangeCacheMisses("RangeCacheMisses", "RCmisses");
+Statistic stats::rangeQueries("RangeQueries", "RQ");
 
 #ifdef DEBUG
 Statistic stats::arrayHashTime("ArrayHashTime", "AHtime");
@@ -27,6 +27,9 @@ namespace stats {
   extern Statistic queryConstructs;
   extern Statistic queryCounterexamples;
   extern Statistic queryTime;
+  extern Statistic rangeCacheHits;
+  extern Statistic rangeCacheMisses;
+  extern Statistic rangeQueries;
   
 #ifdef DEBUG
   extern Statistic arrayHashTime;
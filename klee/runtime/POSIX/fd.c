@@ -27,6 +27,7 @@
 #include <sys/mtio.h>
 #include <termios.h>
 #include <sys/select.h>
+#include <sys/mman.h>
 #include <klee/klee.h>
 
 #include <stdbool.h>
@@ -80,39 +81,31 @@ static exe_disk_file_t *__xqx_get_sym_file(const char *pathname, bool cp_sym, un
 
   //is concrete path
   if( !klee_is_symbolic(pathname[0]) && cp_sym ){
-	  /*fprintf(stderr, "open cp file symbolic: %s \n", pathname);*/
-	  /*const char* concrete_path = __concretize_string(pathname);*/
-	  const char* concrete_path = pathname;
-	  exe_disk_file_t *df = NULL;
+	  unsigned n_ranges = 0;
+	  int index = klee_get_concolic_file(pathname, 0, 0, &n_ranges);
+	  exe_disk_file_t *df;
+	  xqx_sym_buf_t *ranges;
 
-/*#define XQX_TEST_PNG*/
-/*#ifdef XQX_TEST_PNG*/
-      fprintf(stderr, "specified=%s, open=%s, open concrete if they are different\n" ,
-              __sym_parts.path,pathname);
-	  /*if( strcmp(concrete_path, "/tmp/pngtest.png") != 0 ) */
-	  if(!__sym_parts.path || strcmp(concrete_path, __sym_parts.path) != 0 ) 
+	  if (index < 0)
 		  return NULL;
 
-/*#endif*/
-
-	  for (i=0; i<__exe_fs.n_cp_files; ++i) {
-		  if (__exe_fs.cp_files[i].path && 0 == strcmp(__exe_fs.cp_files[i].path, pathname)) 
-		  {
-			  df = &__exe_fs.cp_files[i];
-			  break;
-		  }
-	  }
-	  if( !df ) {
-		  df = klee_create_cp_file(concrete_path, flags);
-		  if (!df)
-			  klee_warning("Unable to open concrete file symbolic.");
+	  // only the first open of a concolic file sees its symbolic contents
+	  if (__exe_fs.cp_files[index].stat)
+		  return NULL;
 
-		  return df;
-	  }
+	  ranges = malloc(sizeof(*ranges) * (n_ranges ? n_ranges : 1));
+	  klee_get_concolic_file(pathname, ranges, n_ranges, &n_ranges);
+	  df = klee_create_cp_file(index, pathname, flags, ranges, n_ranges);
+	  free(ranges);
+	  if (!df)
+		  klee_warning("Unable to open concrete file symbolic.");
 
-	  return NULL;
+	  return df;
   }
 
+  c = pathname[0];
+  if (pathname[1] != 0)
+    return NULL;
 
   for (i=0; i<__exe_fs.n_sym_files; ++i) {
     if (c == 'A' + (char) i) {
@@ -122,9 +115,8 @@ static exe_disk_file_t *__xqx_get_sym_file(const char *pathname, bool cp_sym, un
       return df;
     }
   }
- 
+  
   return NULL;
-
 }
 
 
@@ -466,25 +458,142 @@ ssize_t read(int fd, void *buf, size_t count) {
   }
   else {
     assert(f->off >= 0);
-    if (((off64_t)f->dfile->size) < f->off)
-      return 0;
 /*#define XQX_TEST_PNG*/
 #ifdef XQX_TEST_PNG
 	  fprintf(stderr, "readfile file from %s, off=%x, count=%x \n", 
 			  f->dfile->path, f->off, count  );
 #endif
-    /* symbolic file */
-    if (f->off + count > f->dfile->size) {
-      count = f->dfile->size - f->off;
-    }
-    
-    memcpy(buf, f->dfile->contents + f->off, count);
+    /* symbolic file, copied by the executor */
+    count = klee_read_file_bytes(__concretize_ptr(buf), f->dfile->contents,
+                                 f->dfile->size, f->off,
+                                 __concretize_size(count));
     f->off += count;
     
     return count;
   }
 }
 
+ssize_t __fd_pread(int fd, void *buf, size_t count, off64_t offset) {
+  exe_file_t *f = __get_file(fd);
+  int r;
+
+  if (!f) {
+    errno = EBADF;
+    return -1;
+  }
+
+  if (offset < 0) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  if (count == 0)
+    return 0;
+
+  if (f->dfile)
+    return klee_read_file_bytes(__concretize_ptr(buf), f->dfile->contents,
+                                f->dfile->size, offset,
+                                __concretize_size(count));
+
+  /* concrete file */
+  buf = __concretize_ptr(buf);
+  count = __concretize_size(count);
+  klee_check_memory_access(buf, count);
+  r = syscall(__NR_pread64, f->fd, buf, count, offset);
+  if (r == -1)
+    errno = klee_get_errno();
+  return r;
+}
+
+/* Mappings handed out by __fd_mmap. Aliases point straight into a
+   disk file's contents and own nothing; every other mapping is a heap
+   copy which munmap releases. Protections are not enforced: a store
+   through a PROT_READ alias, which would fault natively, changes the
+   file contents seen by later reads and mappings. */
+typedef struct exe_mapping {
+  void *addr;
+  size_t length;
+  int owned;
+  struct exe_mapping *next;
+} exe_mapping_t;
+
+static exe_mapping_t *__exe_mappings = NULL;
+
+void *__fd_mmap(void *start, size_t length, int prot, int flags, int fd,
+                off64_t offset) {
+  exe_file_t *f = NULL;
+  exe_mapping_t *m;
+  char *addr;
+  int owned;
+
+  if (length == 0 || offset < 0 || (flags & MAP_FIXED)) {
+    errno = EINVAL;
+    return MAP_FAILED;
+  }
+  length = __concretize_size(length);
+
+  if (!(flags & MAP_ANONYMOUS)) {
+    f = __get_file(fd);
+    if (!f) {
+      errno = EBADF;
+      return MAP_FAILED;
+    }
+  }
+
+  if (f && f->dfile && offset + length <= f->dfile->size &&
+      (!(prot & PROT_WRITE) || (flags & MAP_SHARED))) {
+    /* Alias the contents: symbolic bytes stay symbolic and nothing is
+       copied. Shared writable mappings write through to the file, and
+       so do stray stores through read-only ones (see above). */
+    addr = f->dfile->contents + offset;
+    owned = 0;
+  } else {
+    addr = calloc(1, length);
+    if (!addr) {
+      errno = ENOMEM;
+      return MAP_FAILED;
+    }
+    if (f && __fd_pread(fd, addr, length, offset) < 0) {
+      free(addr);
+      return MAP_FAILED;
+    }
+    owned = 1;
+  }
+
+  m = malloc(sizeof(*m));
+  if (!m) {
+    if (owned)
+      free(addr);
+    errno = ENOMEM;
+    return MAP_FAILED;
+  }
+  m->addr = addr;
+  m->length = length;
+  m->owned = owned;
+  m->next = __exe_mappings;
+  __exe_mappings = m;
+  return addr;
+}
+
+int __fd_munmap(void *start, size_t length) {
+  exe_mapping_t **p;
+
+  /* only whole mappings can be released */
+  for (p = &__exe_mappings; *p; p = &(*p)->next) {
+    exe_mapping_t *m = *p;
+    if (m->addr == start) {
+      *p = m->next;
+      if (m->owned)
+        free(m->addr);
+      free(m);
+      return 0;
+    }
+  }
+
+  errno = EINVAL;
+  return -1;
+}
+
 
 ssize_t write(int fd, const void *buf, size_t count) {
   static int n_calls = 0;
@@ -72,21 +72,18 @@ typedef struct {
   int save_all_writes; 
 } exe_sym_env_t;
 
+typedef enum { fill_concrete, fill_assume, fill_sym } xqx_fill_method_t;
+
+/* A symbolic range of a concolic file, in the layout written by
+   klee_get_concolic_file(). */
 typedef struct {
 	unsigned offset;
 	unsigned length;
+	unsigned fill_method;
 }xqx_sym_buf_t;
 
-typedef struct {
-	char *path;
-	unsigned num;
-	enum { fill_concrete, fill_assume, fill_sym } fill_method;
-	xqx_sym_buf_t sym_buf[1024];
-}xqx_make_sym_t;
-
 extern exe_file_system_t __exe_fs;
 extern exe_sym_env_t __exe_env;
-extern xqx_make_sym_t __sym_parts;
 
 void klee_init_fds(unsigned n_files, unsigned file_length, 
 		   int sym_stdout_flag, int do_all_writes_flag, 
@@ -98,6 +95,10 @@ void klee_init_env(int *argcPtr, char ***argvPtr);
 int __fd_open(const char *pathname, int flags, mode_t mode);
 int __fd_openat(int basefd, const char *pathname, int flags, mode_t mode);
 off64_t __fd_lseek(int fd, off64_t offset, int whence);
+ssize_t __fd_pread(int fd, void *buf, size_t count, off64_t offset);
+void *__fd_mmap(void *start, size_t length, int prot, int flags, int fd,
+                off64_t offset);
+int __fd_munmap(void *start, size_t length);
 int __fd_stat(const char *path, struct stat64 *buf);
 int __fd_lstat(const char *path, struct stat64 *buf);
 int __fd_fstat(int fd, struct stat64 *buf);
@@ -107,8 +108,9 @@ int __fd_getdents(unsigned int fd, struct dirent64 *dirp, unsigned int count);
 
 
 int native_read_file(const char* path, int flags, char** _buf);
-exe_disk_file_t* klee_create_cp_file(const char* path, int flags);
-void __xqx_make_file_symbolic(exe_disk_file_t* dfile, char* orig_content, const xqx_make_sym_t* sym_info, unsigned n_syms);
+exe_disk_file_t* klee_create_cp_file(unsigned index, const char* path, int flags,
+                                     const xqx_sym_buf_t *ranges, unsigned n_ranges);
+void __xqx_make_file_symbolic(exe_disk_file_t* dfile, char* orig_content, const xqx_sym_buf_t* ranges, unsigned n_ranges);
 
 
 #endif /* __EXE_FD__ */
@@ -94,6 +94,28 @@ off_t lseek(int fd, off_t off, int whence) {
   return (off_t) __fd_lseek(fd, off, whence);
 }
 
+ssize_t pread(int fd, void *buf, size_t count, off_t offset) {
+  return __fd_pread(fd, buf, count, offset);
+}
+
+ssize_t pread64(int fd, void *buf, size_t count, off64_t offset) {
+  return __fd_pread(fd, buf, count, offset);
+}
+
+void *mmap(void *start, size_t length, int prot, int flags, int fd,
+           off_t offset) {
+  return __fd_mmap(start, length, prot, flags, fd, offset);
+}
+
+void *mmap64(void *start, size_t length, int prot, int flags, int fd,
+             off64_t offset) {
+  return __fd_mmap(start, length, prot, flags, fd, offset);
+}
+
+int munmap(void *start, size_t length) {
+  return __fd_munmap(start, length);
+}
+
 int __xstat(int vers, const char *path, struct stat *buf) {
   struct stat64 tmp;
   int res = __fd_stat(path, &tmp);
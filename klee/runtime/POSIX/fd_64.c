@@ -74,6 +74,24 @@ off64_t lseek(int fd, off64_t offset, int whence) {
   return __fd_lseek(fd, offset, whence);
 }
 
+ssize_t pread(int fd, void *buf, size_t count, off64_t offset) {
+  return __fd_pread(fd, buf, count, offset);
+}
+
+void *mmap(void *start, size_t length, int prot, int flags, int fd,
+           off64_t offset) {
+  return __fd_mmap(start, length, prot, flags, fd, offset);
+}
+
+void *mmap64(void *start, size_t length, int prot, int flags, int fd,
+             off64_t offset) {
+  return __fd_mmap(start, length, prot, flags, fd, offset);
+}
+
+int munmap(void *start, size_t length) {
+  return __fd_munmap(start, length);
+}
+
 //addbyxqx
 /*off64_t lseek64(int fd, off64_t offset, int whence) {*/
   /*return __fd_lseek(fd, offset, whence);*/
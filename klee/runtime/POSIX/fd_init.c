@@ -43,17 +43,6 @@ exe_sym_env_t __exe_env = {
   0
 };
 
-/* add a global struct for make specify parts of a file symbolic
- * addbyxqx201411 for test . it should be spcified by user  
- */
-xqx_make_sym_t __sym_parts = {
-	NULL,
-	0,
-	fill_sym,
-	{{0x103,0x12},{0,0},{0,0},{0,0},{0,0}},
-	/*{0x20, 0x4, fill_sym},*/
-};
-
 #define XQX_DEBUG_PNG
 #define XQX_USE_CONCRETE_FILE_STAT
 /* 
@@ -65,7 +54,7 @@ xqx_make_sym_t __sym_parts = {
  */
 static void __xqx_create_new_dfile(exe_disk_file_t *dfile, unsigned size, char* contents, 
                                const char *name,
-                               const xqx_make_sym_t* sym_infos, unsigned n_sym_info,
+                               const xqx_sym_buf_t* ranges, unsigned n_ranges,
                                struct stat64 *defaults, int is_foreign) {
   struct stat64 *s = malloc(sizeof(*s));
   const char *sp;
@@ -90,8 +79,8 @@ static void __xqx_create_new_dfile(exe_disk_file_t *dfile, unsigned size, char*
     dfile->contents = malloc(dfile->size);
   }
 
-  if( n_sym_info && original_file ) {
-	__xqx_make_file_symbolic(dfile, original_file,  sym_infos, n_sym_info);
+  if( n_ranges && original_file ) {
+	__xqx_make_file_symbolic(dfile, original_file, ranges, n_ranges);
   }
 
 #ifdef XQX_DEBUG_PNG
@@ -270,10 +259,10 @@ void klee_init_fds(unsigned n_files, unsigned file_length,
   else __exe_fs.sym_stdout = NULL;
 
   //addbyxqx201411 setting concrete path file for symboic
-#define XQX_CP_FILES 10
-  __exe_fs.n_cp_files = XQX_CP_FILES;
-  __exe_fs.cp_files = malloc(sizeof(*__exe_fs.cp_files) * XQX_CP_FILES);
-  memset( __exe_fs.cp_files, 0 , sizeof(*__exe_fs.cp_files) * XQX_CP_FILES );
+  // one slot per concolic file given to KLEE, indexed as in its spec
+  __exe_fs.n_cp_files = klee_get_concolic_file(0, 0, 0, 0);
+  __exe_fs.cp_files = calloc(__exe_fs.n_cp_files ? __exe_fs.n_cp_files : 1,
+                             sizeof(*__exe_fs.cp_files));
   
   __exe_env.save_all_writes = save_all_writes_flag;
   /*__exe_env.version = __sym_uint32("model_version");*/
@@ -321,12 +310,12 @@ int native_read_file(const char* path, int flags, char** _buf) {
  *  Copyright: addbyxqx 2014年11月19日 09时09分39秒
  * =====================================================================================
  */
-exe_disk_file_t* klee_create_cp_file(const char* path, int flags) {
-  unsigned k;
+exe_disk_file_t* klee_create_cp_file(unsigned index, const char* path, int flags,
+                                     const xqx_sym_buf_t *ranges, unsigned n_ranges) {
   int fsize;
   struct stat64 def;
   char *buf;
-  int j;
+  exe_disk_file_t *dfile = &__exe_fs.cp_files[index];
 #ifdef XQX_DEBUG_PNG
   fprintf(stderr, "klee_create_cp_file file: %s \n", path);
 #endif
@@ -341,27 +330,11 @@ exe_disk_file_t* klee_create_cp_file(const char* path, int flags) {
 #endif
 
   stat64(".", &def);
-  for (k=0; k < __exe_fs.n_cp_files; k++) {
-    if (!__exe_fs.cp_files[k].stat) {
-      __exe_fs.cp_files[k].path = (char*)malloc(strlen(path)+1);
-      strcpy(__exe_fs.cp_files[k].path, path);
-#ifdef XQX_DEBUG_PNG
-  fprintf(stderr, "klee_create_cp_file file sym_part: num=%d, path=%s \n",__sym_parts.num,__sym_parts.path);
-  for(j=0; j<__sym_parts.num; j++) {
-	  fprintf(stderr, "off=%d, len=%d\n", __sym_parts.sym_buf[j].offset, __sym_parts.sym_buf[j].length);
-  }
-#endif
-      __xqx_create_new_dfile(&__exe_fs.cp_files[k], fsize, buf, path, &__sym_parts, 1, &def, 0);
-
-      
-      return &__exe_fs.cp_files[k];
-    }
-  }
+  dfile->path = (char*)malloc(strlen(path)+1);
+  strcpy(dfile->path, path);
+  __xqx_create_new_dfile(dfile, fsize, buf, path, ranges, n_ranges, &def, 0);
 
-#ifdef XQX_DEBUG_PNG
-  fprintf(stderr, "klee_create_cp_file file end \n");
-#endif
-  return NULL;
+  return dfile;
 }
 
 /* 
@@ -393,73 +366,66 @@ char* getBaseName(char* path)
  *  Copyright: addbyxqx 2014年11月19日 10时40分27秒
  * =====================================================================================
  */
-void __xqx_make_file_symbolic(exe_disk_file_t* dfile, char* orig_content, const xqx_make_sym_t* sym_info, unsigned n_syms)
+void __xqx_make_file_symbolic(exe_disk_file_t* dfile, char* orig_content, const xqx_sym_buf_t* ranges, unsigned n_ranges)
 {
 
 #ifdef XQX_DEBUG_PNG
-  fprintf(stderr, "xqx_make_file_symbolic entry, n_syms = %d \n", n_syms);
+  fprintf(stderr, "xqx_make_file_symbolic entry, n_ranges = %d \n", n_ranges);
 #endif
 	unsigned i = 0;
 	unsigned j = 0;
-	unsigned k = 0;
 	char *name = getBaseName(dfile->path);
 	char symName[256] = {0};
-	/*int isCopy = 0;*/
-	
-  fprintf(stderr, "xqx_make_file_symbolic entry, name = %s path=%s\n",name, dfile->path);
-	
-	for( ;i < n_syms; i++ ) {
-		const xqx_make_sym_t *p = &sym_info[i];
-		switch(p->fill_method) {
-			case fill_concrete:
-				klee_make_symbolic(dfile->contents, dfile->size, dfile->path);
-				if( p->sym_buf[i].offset + p->sym_buf[i].length > dfile->size ){
-					klee_warning("xqx_make_file_symbolic error: out file bound");
-					return;
-				}
-				memcpy( dfile->contents, orig_content, p->sym_buf[i].offset-1);
-				memcpy( dfile->contents + p->sym_buf[i].offset + p->sym_buf[i].length, 
-						orig_content + p->sym_buf[i].offset + p->sym_buf[i].length, 
-						dfile->size - p->sym_buf[i].offset - p->sym_buf[i].length);
-				break;
-			case fill_assume:
-				klee_make_symbolic(dfile->contents, dfile->size, dfile->path);
-				if( p->sym_buf[i].offset + p->sym_buf[i].length > dfile->size ){
-					klee_warning("xqx_make_file_symbolic fill_assume error: out file bound");
-					return;
-				}
-				for(j=0;j<p->sym_buf[i].offset;j++) {
-					klee_assume(dfile->contents[j]==orig_content[j]);
-				}
-				j= p->sym_buf[i].offset + p->sym_buf[i].length;
-				for(;j<dfile->size;j++) {
-					klee_assume(dfile->contents[j]==orig_content[j]);
-				}
-				break;
-			case fill_sym:
-#ifdef XQX_DEBUG_PNG
-  fprintf(stderr, " fill_sym offset=%d, len=%d, dfilesize=%d \n", p->sym_buf[i].offset, p->sym_buf[i].length,dfile->size);
-#endif
-				memcpy( dfile->contents, orig_content, dfile->size);
-				if( p->sym_buf[i].offset + p->sym_buf[i].length > dfile->size ){
-					klee_warning("xqx_make_file_symbolic fill_sym error: out file bound");
-					fprintf(stderr, "xqx_make_file_symbolic fill_sym error: out file bound");
-					return;
-				}
-				for (k=0; k<p->num; k++ ) {
-					char *symbuf = malloc(p->sym_buf[k].length);
-					memcpy(symbuf, orig_content+p->sym_buf[k].offset, p->sym_buf[k].length); 
-					memset(symName, 0, sizeof(symName));
-					sprintf(symName,"%s%d", name, p->sym_buf[k].offset) ;
-					klee_make_symbolic(symbuf, p->sym_buf[k].length, symName);
-					memcpy(dfile->contents+p->sym_buf[k].offset, symbuf, p->sym_buf[k].length);
+	char *covered = NULL;
+	int whole_file = 0, assume_rest = 0;
+
+	memcpy( dfile->contents, orig_content, dfile->size);
+
+	/* fill_concrete and fill_assume ranges are parts of one symbolic
+	 * object covering the whole file, whose other bytes are either
+	 * overwritten with or constrained to their original values. */
+	for( i=0; i < n_ranges; i++ ) {
+		if( ranges[i].offset + ranges[i].length > dfile->size ){
+			klee_warning("xqx_make_file_symbolic error: out file bound");
+			continue;
+		}
+		if( ranges[i].fill_method == fill_sym )
+			continue;
+		if( !covered )
+			covered = calloc(dfile->size, 1);
+		memset(covered + ranges[i].offset, 1, ranges[i].length);
+		whole_file = 1;
+		if( ranges[i].fill_method == fill_assume )
+			assume_rest = 1;
+	}
+
+	if( whole_file ) {
+		klee_make_symbolic(dfile->contents, dfile->size, dfile->path);
+		for( j=0; j < dfile->size; j++ ) {
+			if( covered[j] )
+				continue;
+			if( assume_rest )
+				klee_assume(dfile->contents[j]==orig_content[j]);
+			else
+				dfile->contents[j] = orig_content[j];
+		}
+		free(covered);
+	}
+
+	/* fill_sym ranges are symbolic objects of their own, named after the
+	 * file and the offset of the range. */
+	for( i=0; i < n_ranges; i++ ) {
+		if( ranges[i].fill_method != fill_sym ||
+				ranges[i].offset + ranges[i].length > dfile->size )
+			continue;
+		char *symbuf = malloc(ranges[i].length);
+		memcpy(symbuf, orig_content+ranges[i].offset, ranges[i].length); 
+		memset(symName, 0, sizeof(symName));
+		sprintf(symName,"%s%d", name, ranges[i].offset) ;
+		klee_make_symbolic(symbuf, ranges[i].length, symName);
+		memcpy(dfile->contents+ranges[i].offset, symbuf, ranges[i].length);
 #ifdef XQX_DEBUG_PNG
   fprintf(stderr, "xqx_make_file_symbolic fill_sym : %s\n", symName);
 #endif
-				}
-				break;
-		}
 	}
 }
-
-
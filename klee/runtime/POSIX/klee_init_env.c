@@ -132,8 +132,6 @@ void klee_init_env(int* argcPtr, char*** argvPtr) {
   __set_zero(xargv0,10);
   __set_zero(xargv1,10);
   __set_zero(xargv2,10);
-  
-  unsigned n_sym_file = 0;
 
   sym_arg_name[4] = '\0';
 
@@ -346,62 +344,6 @@ usage: (klee_init_env) [options] [program arguments]\n\
 	}	
 #endif
 
-    else if (__streq(argv[k], "--xqx-sym-file") || __streq(argv[k], "-xqx-sym-file")) {
-	  const char* msg = "--xqx-sym-file expects three integer arguments name offset len method";      
-		
-      if (k+4 >= argc)
-		  __emit_error(msg);
-	  if(n_sym_file > 1023 )
-		  __emit_error("too many sym in file");
-      
-      k++;
-	  int len = __strlen(argv[k]);
-	  char *pathname = malloc(len+1);
-	  memcpy(pathname, argv[k], len);
-	  pathname[len] = 0;
-	  __sym_parts.path = pathname;
-	  k++;
-
-      __sym_parts.sym_buf[n_sym_file].offset = __str_to_int(argv[k++], msg);
-      __sym_parts.sym_buf[n_sym_file].length = __str_to_int(argv[k++], msg);
-      __sym_parts.fill_method = __str_to_int(argv[k++], msg);
-	  
-	  __sym_parts.num = ++n_sym_file;
-
-
-	}
-    else if (__streq(argv[k], "--xqx-confile") || __streq(argv[k], "-xqx-confile")) {
-	  const char* msg = "--xqx-confile expects three integer arguments name [filepath] [num] [method]";      
-      if (k+3 >= argc)
-		  __emit_error(msg);
-
-	  k++;
-	  int len = __strlen(argv[k]);
-	  char *pathname = malloc(len+1);
-	  memcpy(pathname, argv[k], len);
-	  pathname[len] = 0;
-	  __sym_parts.path = pathname;
-	  k++;
-
-	  __sym_parts.num = __str_to_int(argv[k++], msg);
-	  __sym_parts.fill_method = __str_to_int(argv[k++], msg);
-
-	}
-    else if (__streq(argv[k], "--xqx-offlen") || __streq(argv[k], "-xqx-offlen")) {
-	  const char* msg = "--xqx-offlen expects two integer arguments name [off] [len] ";      
-      if (k+2 >= argc)
-		  __emit_error(msg);
-
-	  if( __sym_parts.num==0 || n_sym_file>n_sym_file )
-		  __emit_error("--xqx-offlen must after --xqx-confile and less than its num");
-
-	  k++;
-      __sym_parts.sym_buf[n_sym_file].offset = __str_to_int(argv[k++], msg);
-      __sym_parts.sym_buf[n_sym_file].length = __str_to_int(argv[k++], msg);
-
-	  n_sym_file++;
-
-	}
     else {
       /* simply copy arguments */
       __add_arg(&new_argc, new_argv, argv[k++], 1024);
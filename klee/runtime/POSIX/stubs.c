@@ -530,27 +530,6 @@ ssize_t readahead(int fd, off64_t *offset, size_t count) {
   return -1;
 }
 
-void *mmap(void *start, size_t length, int prot, int flags, int fd, off_t offset) __attribute__((weak));
-void *mmap(void *start, size_t length, int prot, int flags, int fd, off_t offset) {
-  klee_warning("ignoring (EPERM)");
-  errno = EPERM;
-  return (void*) -1;
-}
-
-void *mmap64(void *start, size_t length, int prot, int flags, int fd, off64_t offset) __attribute__((weak));
-void *mmap64(void *start, size_t length, int prot, int flags, int fd, off64_t offset) {
-  klee_warning("ignoring (EPERM)");
-  errno = EPERM;
-  return (void*) -1;
-}
-
-int munmap(void*start, size_t length) __attribute__((weak));
-int munmap(void*start, size_t length) {
-  klee_warning("ignoring (EPERM)");
-  errno = EPERM;
-  return -1;
-}
-
 //addbyxqx201412
 //for some program use __strdup in string2.h, but not linked by klee
 #undef __strdup
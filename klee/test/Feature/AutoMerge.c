@@ -0,0 +1,37 @@
+// RUN: %llvmgcc %s -emit-llvm -O0 -c -o %t.bc
+// RUN: rm -rf %t.klee-out %t.merge-out %t.cost-out
+// RUN: %klee --output-dir=%t.klee-out --focus-funcs=count_flags %t.bc
+// RUN: grep -q "generated tests = 16" %t.klee-out/info
+// RUN: grep -q "auto merges = 0" %t.klee-out/info
+// RUN: %klee --output-dir=%t.merge-out --focus-funcs=count_flags --use-auto-merge %t.bc
+// RUN: not grep -q "auto merges = 0" %t.merge-out/info
+// RUN: not grep -q "generated tests = 16" %t.merge-out/info
+// RUN: %klee --output-dir=%t.cost-out --focus-funcs=count_flags --use-auto-merge --auto-merge-max-cost=0 %t.bc
+// RUN: grep -q "auto merges = 0" %t.cost-out/info
+// RUN: grep -q "generated tests = 16" %t.cost-out/info
+
+#include "klee/klee.h"
+
+// Each flag byte is tested on its own, so every if joins right after
+// its body and the states on both sides can be merged there.
+int count_flags(unsigned char *flags) {
+  int n = 0;
+
+  if (flags[0])
+    n += 1;
+  if (flags[1])
+    n += 2;
+  if (flags[2])
+    n += 4;
+  if (flags[3])
+    n += 8;
+
+  return n;
+}
+
+int main() {
+  unsigned char flags[4];
+
+  klee_make_symbolic(flags, sizeof flags, "flags");
+  return count_flags(flags) == 15;
+}
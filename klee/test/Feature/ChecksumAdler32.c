@@ -0,0 +1,36 @@
+// RUN: %llvmgcc %s -emit-llvm -O0 -c -o %t.bc
+// RUN: rm -rf %t.klee-out %t.replay-out
+// RUN: %klee --output-dir=%t.klee-out --bypass-checksums %t.bc 2> %t.log
+// RUN: grep -q "bypassing 1 checksum comparisons" %t.log
+// RUN: test -f %t.klee-out/test000001.ktest
+// RUN: not test -f %t.klee-out/test000002.ktest
+// RUN: %klee --output-dir=%t.replay-out --replay-out-dir=%t.klee-out %t.bc 2> %t.replay.log
+// RUN: grep -q "checksum ok" %t.replay.log
+
+#include "klee/klee.h"
+
+unsigned adler32(const unsigned char *buf, unsigned len) {
+  unsigned a = 1, b = 0;
+  unsigned i;
+
+  for (i = 0; i < len; ++i) {
+    a = (a + buf[i]) % 65521;
+    b = (b + a) % 65521;
+  }
+  return (b << 16) | a;
+}
+
+int main() {
+  unsigned char buf[8];
+  unsigned stored;
+
+  // four data bytes followed by their Adler-32, big endian as in zlib
+  klee_make_symbolic(buf, sizeof buf, "buf");
+  stored = ((unsigned) buf[4] << 24) | (buf[5] << 16) | (buf[6] << 8) | buf[7];
+
+  // The bypassed comparison always holds; replaying the generated test
+  // without --bypass-checksums shows that its stored value was fixed up.
+  if (adler32(buf, 4) == stored)
+    klee_warning("checksum ok");
+  return 0;
+}
@@ -0,0 +1,27 @@
+// RUN: %llvmgcc %s -emit-llvm -O0 -c -o %t.bc
+// RUN: rm -rf %t.klee-out
+// RUN: %klee --output-dir=%t.klee-out --bypass-checksums %t.bc 2> %t.log
+// RUN: not grep -q "bypassing" %t.log
+// RUN: grep -q "generated tests = 3" %t.klee-out/info
+
+#include "klee/klee.h"
+
+// A byte sum which is only compared with a constant and with a limit
+// is not a checksum: both comparisons have to fork as usual.
+int main() {
+  unsigned char buf[4];
+  unsigned char limit;
+  unsigned sum = 0;
+  unsigned i;
+
+  klee_make_symbolic(buf, sizeof buf, "buf");
+  klee_make_symbolic(&limit, sizeof limit, "limit");
+  for (i = 0; i < sizeof buf; ++i)
+    sum += buf[i];
+
+  if (sum == 0)
+    return 0;
+  if (sum > limit)
+    return 1;
+  return 2;
+}
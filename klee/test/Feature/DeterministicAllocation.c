@@ -0,0 +1,46 @@
+// RUN: %llvmgcc %s -emit-llvm -O0 -c -o %t.bc
+// RUN: rm -rf %t.klee-out %t.klee-out2 %t.klee-out3
+// RUN: %klee --output-dir=%t.klee-out --allocate-determ %t.bc > %t.log
+// RUN: %klee --output-dir=%t.klee-out2 --allocate-determ %t.bc > %t2.log
+// RUN: diff %t.log %t2.log
+// RUN: grep -q "small in arena" %t.log
+// RUN: grep -q "small reused" %t.log
+// RUN: grep -q "large in arena" %t.log
+// RUN: grep -q "large reused" %t.log
+// RUN: not grep -q "instead of" %t.klee-out/messages.txt
+// RUN: %klee --output-dir=%t.klee-out3 --allocate-determ --allocate-determ-size=1 %t.bc > %t3.log 2> %t3.err
+// RUN: grep -q "arena exhausted" %t3.err
+// RUN: grep -q "large outside arena" %t3.log
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define START 0x7ff30000000ULL
+#define SIZE (1ULL << 20)
+
+// The default arena: 100MB at START.
+static const char *where(void *p) {
+  unsigned long long a = (unsigned long long) (unsigned long) p;
+  return a >= START && a < START + 100 * SIZE ? "in arena" : "outside arena";
+}
+
+int main() {
+  char *a, *b, *c;
+
+  // Blocks of the same size class come back in LIFO order.
+  a = malloc(20);
+  b = malloc(20);
+  printf("small %s: %p %p\n", where(a), a, b);
+  free(b);
+  c = malloc(30);
+  printf("small %s\n", c == b ? "reused" : "not reused");
+
+  // Large blocks are reused best fit.
+  a = malloc(2 * SIZE);
+  printf("large %s: %p\n", where(a), a);
+  free(a);
+  b = malloc(SIZE + SIZE / 2);
+  printf("large %s\n", b == a ? "reused" : "not reused");
+
+  return 0;
+}
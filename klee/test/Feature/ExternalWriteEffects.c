@@ -0,0 +1,33 @@
+// RUN: %llvmgcc %s -fno-builtin -emit-llvm -O0 -c -o %t.bc
+// RUN: rm -rf %t.klee-out %t.skip-out
+// RUN: %klee --output-dir=%t.klee-out --external-no-writes=strcpy %t.bc > %t.log
+// RUN: grep -q "missed write: a aaaa" %t.log
+// RUN: grep -q "declared write: c cccc" %t.log
+// RUN: grep -q "n = 4" %t.log
+// RUN: %klee --output-dir=%t.skip-out --external-no-writes=strcpy --external-skip-synced-copy-out %t.bc > %t.skip.log
+// RUN: grep -q "missed write: a bbbb" %t.skip.log
+// RUN: grep -q "declared write: c cccc" %t.skip.log
+
+#include <stdio.h>
+#include <string.h>
+
+int main() {
+  char buf[8] = "aaaa";
+  int n = 0;
+
+  // Wrongly declared to write nothing, so the executor keeps "aaaa".
+  // By default the next external call is handed those bytes again; with
+  // the versioned copy-out the host keeps the write nobody copied in.
+  strcpy(buf, "bbbb");
+  printf("missed write: %c %s\n", buf[0], buf);
+
+  // sprintf writes through its pointer arguments, as declared.
+  sprintf(buf, "cccc");
+  printf("declared write: %c %s\n", buf[0], buf);
+
+  // %n writes through a variadic pointer argument of printf.
+  printf("abcd%n\n", &n);
+  printf("n = %d\n", n);
+
+  return 0;
+}
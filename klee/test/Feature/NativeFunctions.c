@@ -0,0 +1,40 @@
+// RUN: %llvmgcc %s -fno-builtin -emit-llvm -O0 -c -o %t.bc
+// RUN: rm -rf %t.klee-out
+// RUN: %klee --output-dir=%t.klee-out --native-functions=skip_spaces,copy_word %t.bc > %t.log
+// RUN: grep -q "skipped 2: abc" %t.log
+// RUN: grep -q "copied: xbc" %t.log
+// RUN: grep -q "native calls = 1$" %t.klee-out/info
+// RUN: not grep -q "ERROR" %t.klee-out/messages.txt
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Returns a pointer into its argument, which the state knows about, so
+// it runs natively.
+char *skip_spaces(char *s) {
+  while (*s == ' ')
+    ++s;
+  return s;
+}
+
+// Allocates through strdup, so it is interpreted: memory malloc'ed by
+// native code would be unknown to the state.
+char *copy_word(const char *s) {
+  return strdup(s);
+}
+
+int main() {
+  char buf[] = "  abc";
+  char *word = skip_spaces(buf);
+  char *copy;
+
+  printf("skipped %d: %s\n", (int) (word - buf), word);
+
+  copy = copy_word(word);
+  copy[0] = 'x';
+  printf("copied: %s\n", copy);
+  free(copy);
+
+  return 0;
+}
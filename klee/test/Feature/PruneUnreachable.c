@@ -0,0 +1,42 @@
+// RUN: %llvmgcc %s -emit-llvm -O0 -c -o %t.bc
+// RUN: rm -rf %t.klee-out %t.prune-out
+// RUN: %klee --output-dir=%t.klee-out --focus-funcs=target %t.bc
+// RUN: grep -q "generated tests = 17" %t.klee-out/info
+// RUN: grep -q "pruned states = 0" %t.klee-out/info
+// RUN: %klee --output-dir=%t.prune-out --focus-funcs=target --prune-unreachable-states --uncovered-update-interval=0.01 %t.bc 2> %t.prune.log
+// RUN: grep -q "pruned 1 states unable to reach uncovered focused code" %t.prune.log
+// RUN: grep -q "pruned states = 1" %t.prune-out/info
+// RUN: grep -q "generated tests = 1$" %t.prune-out/info
+
+#include "klee/klee.h"
+
+// Its return stays uncovered while it spins.
+int target(int x) {
+  unsigned spin = 0;
+  int i;
+
+  for (i = 0; i < 2000000; i++)
+    spin += i;
+  return x + (spin & 1);
+}
+
+int main() {
+  int a, b, i, n = 0;
+  unsigned spin = 0;
+
+  klee_make_symbolic(&a, sizeof a, "a");
+  klee_make_symbolic(&b, sizeof b, "b");
+
+  if (a > 0)
+    return target(b);
+
+  // No path from here calls target, so the state is pruned while it
+  // spins, before it forks on b; it is terminated only once.
+  for (i = 0; i < 1000000; i++)
+    spin += i;
+  for (i = 0; i < 4; i++)
+    if (b & (1 << i))
+      n++;
+
+  return n + (spin & 1);
+}
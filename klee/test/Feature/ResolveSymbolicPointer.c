@@ -0,0 +1,48 @@
+// RUN: %llvmgcc %s -emit-llvm -O0 -c -o %t.bc
+// RUN: rm -rf %t.klee-out %t.klee-out2
+// RUN: %klee --output-dir=%t.klee-out %t.bc > %t.log
+// RUN: %klee --output-dir=%t.klee-out2 --max-resolve-candidates=0 %t.bc > %t2.log
+// RUN: sort %t.log > %t.sorted
+// RUN: sort %t2.log > %t2.sorted
+// RUN: diff %t.sorted %t2.sorted
+// RUN: grep -q "entry 0" %t.log
+// RUN: grep -q "entry 1" %t.log
+// RUN: grep -q "entry 2" %t.log
+// RUN: grep -q "entry 3" %t.log
+// RUN: test `grep -c "buf ok" %t.log` -eq 4
+// RUN: test `ls %t.klee-out | grep -c "ptr.err"` -eq 1
+// RUN: test `ls %t.klee-out2 | grep -c "ptr.err"` -eq 1
+// RUN: grep -q "generated tests = 7" %t.klee-out/info
+
+#include "klee/klee.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// More objects than --max-resolve-candidates, so that the sign extended
+// indices below cannot be bounded from the structure of the address
+// alone.
+#define N 300
+
+int main() {
+  char *objs[N];
+  char buf[4] = { 1, 2, 3, 4 };
+  int i, k;
+
+  for (k = 0; k < N; k++) {
+    objs[k] = malloc(4);
+    objs[k][0] = k % 100;
+  }
+
+  klee_make_symbolic(&i, sizeof i, "i");
+
+  // The loaded pointer is symbolic: it resolves to one of four objects.
+  if (i >= 0 && i < 4)
+    printf("entry %d\n", objs[i][0]);
+
+  // Indices 4 to 7 run off the end of buf.
+  if (i >= 0 && i < 8 && buf[i])
+    printf("buf ok\n");
+
+  return 0;
+}
@@ -0,0 +1,33 @@
+// RUN: %llvmgcc -emit-llvm -c -g %s -o %t.bc
+// RUN: rm -rf %t.seed.out %t.out
+// RUN: %klee --output-dir=%t.seed.out %t.bc "initial"
+// RUN: test -f %t.seed.out/test000001.ktest
+// RUN: %klee --output-dir=%t.out --seed-out %t.seed.out/test000001.ktest --speculative-fork %t.bc > %t.log
+// RUN: grep -q "large" %t.log
+// RUN: grep -q "small" %t.log
+// RUN: not grep -q "unreachable" %t.log
+// RUN: test -f %t.out/test000002.ktest
+// RUN: not test -f %t.out/test000003.ktest
+
+#include <stdio.h>
+
+int main(int argc, char **argv) {
+  int a;
+
+  klee_make_symbolic(&a, sizeof a, "a");
+  if (argc == 2)
+    klee_assume(a == 20);
+
+  if (a > 10) {
+    // The non-seed side of this branch is infeasible and must be
+    // discarded without a test case.
+    if (a < 5)
+      printf("unreachable\n");
+    else
+      printf("large\n");
+  } else {
+    printf("small\n");
+  }
+
+  return 0;
+}
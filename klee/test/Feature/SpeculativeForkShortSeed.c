@@ -0,0 +1,37 @@
+// RUN: %llvmgcc -emit-llvm -c -g %s -o %t.bc
+// RUN: rm -rf %t.seed.out %t.out %t.full.out
+// RUN: %klee --output-dir=%t.seed.out %t.bc short
+// RUN: test -f %t.seed.out/test000001.ktest
+// RUN: not test -f %t.seed.out/test000002.ktest
+// RUN: %klee --output-dir=%t.out --seed-out %t.seed.out/test000001.ktest --allow-seed-extension --speculative-fork %t.bc > %t.log
+// RUN: grep -q "speculative forks = 0" %t.out/info
+// RUN: grep -q "generated tests = 4" %t.out/info
+// RUN: grep -q "^a$" %t.log
+// RUN: grep -q "^not a$" %t.log
+// RUN: %klee --output-dir=%t.full.out --seed-out %t.out/test000001.ktest --speculative-fork %t.bc > %t.full.log
+// RUN: grep -q "speculative forks = [1-9]" %t.full.out/info
+
+#include <stdio.h>
+#include <stdlib.h>
+
+int main(int argc, char **argv) {
+  unsigned n = argc > 1 ? 1 : 2;
+  char *buf = malloc(n);
+
+  klee_make_symbolic(buf, n, "buf");
+  if (argc > 1)
+    return 0;
+
+  // Past the end of the short seed buf[1] is free, so the seed cannot be
+  // checked against this constraint and must not pick the direction of
+  // the next branch on its own.
+  if (buf[1] > 10)
+    printf("large\n");
+
+  if (buf[0] == 'a')
+    printf("a\n");
+  else
+    printf("not a\n");
+
+  return 0;
+}
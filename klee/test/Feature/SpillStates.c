@@ -0,0 +1,43 @@
+// RUN: %llvmgcc %s -emit-llvm -O0 -c -o %t.bc
+// RUN: rm -rf %t.klee-out %t.spill-out
+// RUN: %klee --output-dir=%t.klee-out %t.bc > %t.log
+// RUN: %klee --output-dir=%t.spill-out --max-memory=10 --spill-states %t.bc > %t.spill.log 2> %t.spill.err
+// RUN: grep -q "spilling" %t.spill.err
+// RUN: grep -q "generated tests = 4" %t.klee-out/info
+// RUN: grep -q "generated tests = 4" %t.spill-out/info
+// RUN: not grep -q "diverged" %t.spill.err
+// RUN: not grep -q "were not reloaded" %t.spill.err
+// RUN: sort %t.log > %t.sorted
+// RUN: sort %t.spill.log > %t.spill.sorted
+// RUN: diff %t.sorted %t.spill.sorted
+// RUN: ls %t.spill-out | not grep -q "spill.*ktest"
+
+#include "klee/klee.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+int main() {
+  unsigned char x[2];
+  int path = 0, i, j;
+  unsigned sum = 0;
+
+  klee_make_symbolic(x, sizeof x, "x");
+  if (x[0] > 100)
+    path |= 1;
+  if (x[1] > 100)
+    path |= 2;
+
+  // 128 MBs on every path, well over the cap once two paths hold it,
+  // so the colder states get spilled and reloaded later.
+  for (i = 0; i < 64; i++) {
+    char *p = malloc(1 << 21);
+    p[0] = path;
+    // Ensure we hit the periodic memory check
+    for (j = 0; j < 10000; j++)
+      sum += (unsigned) p[0];
+  }
+
+  printf("path %d sum %u\n", path, sum);
+  return 0;
+}
@@ -0,0 +1,49 @@
+// RUN: %llvmgcc %s -emit-llvm -O0 -c -o %t.bc
+// RUN: printf "abcdefgh" > %t.a
+// RUN: printf "wxyz" > %t.b
+// RUN: echo "@%t.a" > %t.conf
+// RUN: echo "0-2:2, 4-2:0" >> %t.conf
+// RUN: echo "@%t.b" >> %t.conf
+// RUN: echo "1-3:1" >> %t.conf
+// RUN: rm -rf %t.klee-out
+// RUN: %klee --output-dir=%t.klee-out --exit-on-error --posix-runtime --sym-conf-file=%t.conf %t.bc %t.a %t.b
+// RUN: test -f %t.klee-out/test000001.ktest
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <assert.h>
+#include "klee/klee.h"
+
+int main(int argc, char **argv) {
+  char a[8], b[4];
+  int fd, i;
+
+  assert(argc == 3);
+
+  fd = open(argv[1], O_RDONLY);
+  assert(fd != -1);
+  assert(read(fd, a, sizeof a) == sizeof a);
+  close(fd);
+
+  // fill_sym (2) range 0-2 and fill_concrete (0) range 4-2; the rest of
+  // the file keeps its concrete contents.
+  assert(klee_is_symbolic(a[0]) && klee_is_symbolic(a[1]));
+  assert(!klee_is_symbolic(a[2]) && a[2] == 'c');
+  assert(!klee_is_symbolic(a[3]) && a[3] == 'd');
+  assert(klee_is_symbolic(a[4]) && klee_is_symbolic(a[5]));
+  assert(!klee_is_symbolic(a[6]) && a[6] == 'g');
+  assert(!klee_is_symbolic(a[7]) && a[7] == 'h');
+
+  fd = open(argv[2], O_RDONLY);
+  assert(fd != -1);
+  assert(read(fd, b, sizeof b) == sizeof b);
+  close(fd);
+
+  // fill_assume (1) range 1-3: the byte outside it is constrained to its
+  // original value.
+  assert(b[0] == 'w');
+  for (i = 1; i < 4; ++i)
+    assert(klee_is_symbolic(b[i]));
+
+  return 0;
+}
@@ -0,0 +1,36 @@
+// RUN: %llvmgcc %s -emit-llvm -O0 -c -o %t.bc
+// RUN: printf "HDR!abcd\001\003" > %t.in
+// RUN: rm -rf %t.klee-out
+// RUN: %klee --output-dir=%t.klee-out --posix-runtime --focus-funcs=parse --concolic-file-path=%t.in --infer-sym-ranges %t.bc %t.in
+// RUN: grep -q "explored paths = 1$" %t.klee-out/info
+// RUN: test `wc -l < %t.klee-out/sym-ranges.conf` -eq 3
+// RUN: sed -n 1p %t.klee-out/sym-ranges.conf | grep -x "@%t.in"
+// RUN: sed -n 2p %t.klee-out/sym-ranges.conf | grep -x "0-4"
+// RUN: sed -n 3p %t.klee-out/sym-ranges.conf | grep -x "9-1"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+// Only the magic and the version byte are branched on; the payload in
+// bytes 4-8 is copied around but never tested.
+int parse(const unsigned char *buf) {
+  if (buf[0] != 'H' || buf[1] != 'D' || buf[2] != 'R' || buf[3] != '!')
+    return -1;
+  if (buf[9] > 4)
+    return -1;
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  unsigned char buf[10];
+  int fd;
+
+  if (argc != 2)
+    return 1;
+  fd = open(argv[1], O_RDONLY);
+  if (fd < 0 || read(fd, buf, sizeof buf) != sizeof buf)
+    return 1;
+  close(fd);
+
+  return parse(buf) != 0;
+}
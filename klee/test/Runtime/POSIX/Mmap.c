@@ -0,0 +1,63 @@
+// RUN: %llvmgcc %s -emit-llvm -O0 -c -o %t.bc
+// RUN: %klee --exit-on-error --posix-runtime %t.bc --sym-files 1 8 >%t.log
+
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <assert.h>
+#include "klee/klee.h"
+
+int main(int argc, char** argv) {
+  char *ro, *cow, *shared, *past;
+  char c;
+  int i;
+
+  int fd = open("A", O_RDWR);
+  assert(fd != -1);
+
+  // A read-only mapping aliases the file: its bytes stay symbolic.
+  ro = mmap(0, 8, PROT_READ, MAP_PRIVATE, fd, 0);
+  assert(ro != MAP_FAILED);
+  for (i = 0; i < 8; ++i)
+    assert(klee_is_symbolic(ro[i]));
+
+  // A private writable mapping is a copy: writes stay out of the file.
+  cow = mmap(0, 8, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  assert(cow != MAP_FAILED && cow != ro);
+  assert(klee_is_symbolic(cow[1]));
+  cow[0] = 'z';
+  assert(pread(fd, &c, 1, 0) == 1);
+  assert(klee_is_symbolic(c));
+  assert(klee_is_symbolic(ro[0]));
+
+  // A shared writable mapping writes through to the file.
+  shared = mmap(0, 4, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 4);
+  assert(shared != MAP_FAILED);
+  shared[0] = 'k';
+  assert(pread(fd, &c, 1, 4) == 1);
+  assert(c == 'k');
+  assert(ro[4] == 'k');
+
+  // A mapping past EOF is a copy whose tail is zero filled.
+  past = mmap(0, 16, PROT_READ, MAP_PRIVATE, fd, 4);
+  assert(past != MAP_FAILED);
+  assert(past[0] == 'k');
+  assert(klee_is_symbolic(past[1]));
+  for (i = 4; i < 16; ++i)
+    assert(past[i] == 0);
+
+  // Unmapping an alias releases the mapping, not the file contents.
+  assert(munmap(ro, 8) == 0);
+  assert(munmap(ro, 8) == -1 && errno == EINVAL);
+  assert(munmap(shared, 4) == 0);
+  assert(pread(fd, &c, 1, 4) == 1);
+  assert(c == 'k');
+  assert(munmap(cow, 8) == 0);
+  assert(munmap(past, 16) == 0);
+
+  close(fd);
+  return 0;
+}
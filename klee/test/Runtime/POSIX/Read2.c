@@ -0,0 +1,61 @@
+// RUN: %llvmgcc %s -emit-llvm -O0 -c -o %t.bc
+// RUN: %klee --exit-on-error --posix-runtime %t.bc --sym-files 1 8 >%t.log
+
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <assert.h>
+#include "klee/klee.h"
+
+int main(int argc, char** argv) {
+  char buf[16];
+  int i, x;
+
+  int fd = open("A", O_RDWR);
+  assert(fd != -1);
+
+  // Overwrite two bytes so the file mixes symbolic and concrete bytes.
+  assert(lseek(fd, 2, SEEK_SET) == 2);
+  assert(write(fd, "xy", 2) == 2);
+  assert(lseek(fd, 0, SEEK_SET) == 0);
+
+  // A read past the end of the file is clipped at EOF.
+  for (i = 0; i < 16; ++i)
+    buf[i] = '.';
+  x = read(fd, buf, sizeof buf);
+  assert(x == 8);
+  assert(klee_is_symbolic(buf[0]) && klee_is_symbolic(buf[1]));
+  assert(buf[2] == 'x' && buf[3] == 'y');
+  for (i = 4; i < 8; ++i)
+    assert(klee_is_symbolic(buf[i]));
+  for (i = 8; i < 16; ++i)
+    assert(buf[i] == '.');
+
+  // At EOF, and at offsets past it, nothing is read.
+  x = read(fd, buf, 1);
+  assert(x == 0);
+  assert(lseek(fd, 100, SEEK_SET) == 100);
+  x = read(fd, buf, 1);
+  assert(x == 0);
+
+  // pread reads at the given offset and leaves the file offset alone.
+  buf[0] = buf[1] = '.';
+  x = pread(fd, buf, 4, 3);
+  assert(x == 4);
+  assert(buf[0] == 'y');
+  assert(klee_is_symbolic(buf[1]));
+  x = pread(fd, buf, 4, 6);
+  assert(x == 2);
+  x = pread(fd, buf, 4, 8);
+  assert(x == 0);
+  x = pread(fd, buf, 4, 100);
+  assert(x == 0);
+  x = pread(fd, buf, 4, -1);
+  assert(x == -1 && errno == EINVAL);
+  assert(lseek(fd, 0, SEEK_CUR) == 100);
+
+  close(fd);
+  return 0;
+}
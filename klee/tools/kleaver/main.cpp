@@ -17,6 +17,7 @@
 
 #include "klee/util/ExprUtil.h"
 #include "klee/util/ExprSMTLIBLetPrinter.h"
+#include "klee/Internal/Support/Timer.h"
 
 #include "llvm/ADT/OwningPtr.h"
 #include "llvm/ADT/StringExtras.h"
@@ -25,6 +26,12 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <algorithm>
+#include <map>
+#include <set>
+#include <sstream>
+
+#include <dirent.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
@@ -73,7 +80,8 @@ namespace {
     PrintTokens,
     PrintAST,
     PrintSMTLIBv2,
-    Evaluate
+    Evaluate,
+    Benchmark
   };
 
   static llvm::cl::opt<ToolActions> 
@@ -88,6 +96,8 @@ namespace {
                         "Print parsed AST nodes from the input file."),
              clEnumValN(Evaluate, "evaluate",
                         "Print parsed AST nodes from the input file."),
+             clEnumValN(Benchmark, "benchmark",
+                        "Replay the queries in the input file (or in every .pc file of the input directory) and report solver chain timings, checking the answers the logs recorded."),
              clEnumValEnd));
 
 
@@ -114,6 +124,11 @@ namespace {
   UseDummySolver("use-dummy-solver",
 		   cl::init(false));
 
+  llvm::cl::opt<unsigned>
+  BenchmarkRounds("benchmark-rounds",
+                  llvm::cl::desc("Number of times --benchmark replays the unique queries (default=1)."),
+                  llvm::cl::init(1));
+
   llvm::cl::opt<std::string> directoryToWriteQueryLogs("query-log-dir",llvm::cl::desc("The folder to write query logs to. Defaults is current working directory."),
 		                                               llvm::cl::init("."));
 
@@ -405,6 +420,382 @@ static bool EvaluateInputAST(const char *Filename,
   return success;
 }
 
+/// BenchmarkLayer - Forward every query to the underlying solver and
+/// record the wall time of each call, including the layers below.
+class BenchmarkLayer : public SolverImpl {
+private:
+  Solver *solver;
+
+public:
+  const char *name;
+  std::vector<uint64_t> samples;
+
+  BenchmarkLayer(Solver *_solver, const char *_name)
+    : solver(_solver), name(_name) {}
+  ~BenchmarkLayer() { delete solver; }
+
+  bool computeValidity(const Query& query, Solver::Validity &result) {
+    WallTimer timer;
+    bool success = solver->impl->computeValidity(query, result);
+    samples.push_back(timer.check());
+    return success;
+  }
+  bool computeTruth(const Query& query, bool &isValid) {
+    WallTimer timer;
+    bool success = solver->impl->computeTruth(query, isValid);
+    samples.push_back(timer.check());
+    return success;
+  }
+  bool computeValue(const Query& query, ref<Expr> &result) {
+    WallTimer timer;
+    bool success = solver->impl->computeValue(query, result);
+    samples.push_back(timer.check());
+    return success;
+  }
+  bool computeFeasibility(const ConstraintManager &constraints,
+                          const std::vector< ref<Expr> > &exprs,
+                          std::vector<bool> &results) {
+    WallTimer timer;
+    bool success = solver->impl->computeFeasibility(constraints, exprs, 
+                                                    results);
+    samples.push_back(timer.check());
+    return success;
+  }
+  bool computeRange(const Query& query, uint64_t &min, uint64_t &max) {
+    WallTimer timer;
+    bool success = solver->impl->computeRange(query, min, max);
+    samples.push_back(timer.check());
+    return success;
+  }
+  bool computeInitialValues(const Query& query,
+                            const std::vector<const Array*> &objects,
+                            std::vector< std::vector<unsigned char> > &values,
+                            bool &hasSolution) {
+    WallTimer timer;
+    bool success = solver->impl->computeInitialValues(query, objects, values,
+                                                      hasSolution);
+    samples.push_back(timer.check());
+    return success;
+  }
+  SolverRunStatus getOperationStatusCode() {
+    return solver->impl->getOperationStatusCode();
+  }
+  char *getConstraintLog(const Query& query) {
+    return solver->impl->getConstraintLog(query);
+  }
+  void setCoreSolverTimeout(double timeout) {
+    solver->impl->setCoreSolverTimeout(timeout);
+  }
+};
+
+/// BenchmarkQuery - A logged query with its constraints in canonical
+/// order.
+struct BenchmarkQuery {
+  ConstraintManager constraints;
+  ref<Expr> query;
+  std::vector< ref<Expr> > values;
+  std::vector<const Array*> objects;
+  /// The answer the log recorded: whether the query is valid, or for a
+  /// query for initial values, whether it is solvable; -1 if none.
+  int expected;
+  /// Where the query was read from, for reporting wrong answers.
+  std::string origin;
+
+  BenchmarkQuery() : expected(-1) {}
+};
+
+/// Collect the query logs to replay: either the given file or every
+/// .pc file in the given directory, in name order.
+static bool getBenchmarkInputs(const std::string &path,
+                               std::vector<std::string> &files) {
+  struct stat s;
+  if (stat(path.c_str(), &s) != 0) {
+    std::cerr << "error: unable to stat \"" << path << "\"\n";
+    return false;
+  }
+
+  if (!S_ISDIR(s.st_mode)) {
+    files.push_back(path);
+    return true;
+  }
+
+  DIR *dir = opendir(path.c_str());
+  if (!dir) {
+    std::cerr << "error: unable to open directory \"" << path << "\"\n";
+    return false;
+  }
+  while (struct dirent *entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    if (name.size() > 3 && name.compare(name.size() - 3, 3, ".pc") == 0)
+      files.push_back(path + "/" + name);
+  }
+  closedir(dir);
+
+  std::sort(files.begin(), files.end());
+  return true;
+}
+
+/// Collect the answers a query log recorded, one per "# Query N" header
+/// in order: 1 or 0 for "Is Valid", "Validity" (valid only if 1) and
+/// "Solvable" comments, -1 for a query without one.  Files without
+/// headers, such as hand-written ones, yield no answers.
+static void getRecordedAnswers(const MemoryBuffer *MB,
+                               std::vector<int> &answers) {
+  std::istringstream in(std::string(MB->getBufferStart(),
+                                    MB->getBufferEnd()));
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.compare(0, 8, "# Query ") == 0) {
+      answers.push_back(-1);
+    } else if (!answers.empty()) {
+      if (line.compare(0, 14, "#   Is Valid: ") == 0)
+        answers.back() = line.compare(14, 4, "true") == 0;
+      else if (line.compare(0, 14, "#   Validity: ") == 0)
+        answers.back() = line.compare(14, std::string::npos, "1") == 0;
+      else if (line.compare(0, 14, "#   Solvable: ") == 0)
+        answers.back() = line.compare(14, 4, "true") == 0;
+    }
+  }
+}
+
+/// Put the constraints of a parsed query in a canonical order and
+/// return its printed form, which identifies duplicates across logs
+/// (arrays are compared by name and declaration rather than by
+/// address).
+static std::string canonicalizeQuery(QueryCommand *QC, BenchmarkQuery &BQ) {
+  std::vector< std::pair<std::string, ref<Expr> > > sorted;
+  for (std::vector<ExprHandle>::const_iterator it = QC->Constraints.begin(),
+         ie = QC->Constraints.end(); it != ie; ++it) {
+    std::ostringstream os;
+    ExprPPrinter::printSingleExpr(os, *it);
+    sorted.push_back(std::make_pair(os.str(), *it));
+  }
+  std::sort(sorted.begin(), sorted.end());
+
+  std::vector< ref<Expr> > constraints;
+  for (unsigned i = 0, e = sorted.size(); i != e; ++i)
+    if (i == 0 || sorted[i].first != sorted[i - 1].first)
+      constraints.push_back(sorted[i].second);
+
+  BQ.constraints = ConstraintManager(constraints);
+  BQ.query = QC->Query;
+  BQ.values.assign(QC->Values.begin(), QC->Values.end());
+  BQ.objects = QC->Objects;
+
+  std::ostringstream key;
+  ExprPPrinter::printQuery(key, BQ.constraints, BQ.query,
+                           BQ.values.empty() ? 0 : &BQ.values[0],
+                           BQ.values.empty() ? 0 : &BQ.values[0] + BQ.values.size(),
+                           BQ.objects.empty() ? 0 : &BQ.objects[0],
+                           BQ.objects.empty() ? 0 : &BQ.objects[0] + BQ.objects.size());
+  return key.str();
+}
+
+/// Issue the solver request a query command describes.  On success,
+/// \a answer is set to whether the query is valid, or for a query for
+/// initial values, whether it is solvable; value queries always answer
+/// true.
+static bool replayQuery(Solver *S, const BenchmarkQuery &BQ, bool &answer) {
+  Query query(BQ.constraints, BQ.query);
+  answer = true;
+
+  if (!BQ.values.empty()) {
+    bool success = true;
+    for (unsigned i = 0, e = BQ.values.size(); i != e; ++i) {
+      ref<ConstantExpr> result;
+      success &= S->getValue(query.withExpr(BQ.values[i]), result);
+    }
+    return success;
+  }
+
+  if (!BQ.objects.empty()) {
+    std::vector< std::vector<unsigned char> > result;
+    // An unsatisfiable query also reports failure here, so only count
+    // real solver failures.
+    if (S->getInitialValues(query, BQ.objects, result))
+      return true;
+    answer = false;
+    return S->impl->getOperationStatusCode() != 
+      SolverImpl::SOLVER_RUN_STATUS_TIMEOUT;
+  }
+
+  return S->mustBeTrue(query, answer);
+}
+
+/// Return the p-th percentile (nearest rank) of the sorted samples.
+static uint64_t getPercentile(const std::vector<uint64_t> &sorted, 
+                              unsigned p) {
+  if (sorted.empty())
+    return 0;
+  unsigned rank = (p * sorted.size() + 99) / 100;
+  return sorted[rank ? rank - 1 : 0];
+}
+
+static void printCacheStats(const char *name, const char *hitsName,
+                            const char *missesName, bool last) {
+  uint64_t hits = *theStatisticManager->getStatisticByName(hitsName);
+  uint64_t misses = *theStatisticManager->getStatisticByName(missesName);
+  std::cout << "    \"" << name << "\": { \"hits\": " << hits
+            << ", \"misses\": " << misses
+            << ", \"hit_rate\": "
+            << (hits + misses ? (double) hits / (hits + misses) : 0.)
+            << " }" << (last ? "\n" : ",\n");
+}
+
+static bool BenchmarkQueryLogs(const std::string &Path,
+                               ExprBuilder *Builder) {
+  std::vector<std::string> files;
+  if (!getBenchmarkInputs(Path, files))
+    return false;
+
+  // Load and deduplicate the queries.
+  std::vector<BenchmarkQuery> queries;
+  std::map<std::string, unsigned> seen;
+  unsigned NumParsed = 0;
+  bool success = true;
+  for (std::vector<std::string>::iterator fit = files.begin(),
+         fie = files.end(); fit != fie; ++fit) {
+    OwningPtr<MemoryBuffer> MB;
+    error_code ec = MemoryBuffer::getFile(fit->c_str(), MB);
+    if (ec) {
+      std::cerr << *fit << ": error: " << ec.message() << "\n";
+      success = false;
+      continue;
+    }
+
+    std::vector<Decl*> Decls;
+    Parser *P = Parser::Create(fit->c_str(), MB.get(), Builder);
+    P->SetMaxErrors(20);
+    while (Decl *D = P->ParseTopLevelDecl())
+      Decls.push_back(D);
+
+    if (unsigned N = P->GetNumErrors()) {
+      std::cerr << *fit << ": parse failure: "
+                << N << " errors.\n";
+      success = false;
+    } else {
+      std::vector<int> answers;
+      getRecordedAnswers(MB.get(), answers);
+      unsigned index = 0;
+      for (std::vector<Decl*>::iterator it = Decls.begin(),
+             ie = Decls.end(); it != ie; ++it) {
+        if (QueryCommand *QC = dyn_cast<QueryCommand>(*it)) {
+          ++NumParsed;
+          BenchmarkQuery BQ;
+          if (index < answers.size())
+            BQ.expected = answers[index];
+          BQ.origin = *fit + ": query " + llvm::utostr(index);
+          ++index;
+
+          std::pair<std::map<std::string, unsigned>::iterator, bool> res =
+            seen.insert(std::make_pair(canonicalizeQuery(QC, BQ),
+                                       (unsigned) queries.size()));
+          if (res.second)
+            queries.push_back(BQ);
+          else if (queries[res.first->second].expected == -1)
+            queries[res.first->second].expected = BQ.expected;
+        }
+      }
+    }
+
+    for (std::vector<Decl*>::iterator it = Decls.begin(),
+           ie = Decls.end(); it != ie; ++it)
+      delete *it;
+    delete P;
+  }
+
+  if (!success)
+    return false;
+
+  // Build the chain bottom-up with a timing layer on top of each stage,
+  // mirroring constructSolverChain() (query logging and validation are
+  // left out, as they would distort the timings).
+  std::vector<BenchmarkLayer*> layers;
+  Solver *S = UseDummySolver ? createDummySolver() : 
+    new STPSolver(UseForkedCoreSolver, CoreSolverOptimizeDivides);
+  if (!UseDummySolver && 0 != MaxCoreSolverTime)
+    S->setCoreSolverTimeout(MaxCoreSolverTime);
+
+  layers.push_back(new BenchmarkLayer(S, "core"));
+  S = new Solver(layers.back());
+
+  if (UseFastCexSolver) {
+    layers.push_back(new BenchmarkLayer(createFastCexSolver(S), "fast-cex"));
+    S = new Solver(layers.back());
+  }
+  if (UseCexCache) {
+    layers.push_back(new BenchmarkLayer(createCexCachingSolver(S), 
+                                        "cex-cache"));
+    S = new Solver(layers.back());
+  }
+  if (UseCache) {
+    layers.push_back(new BenchmarkLayer(createCachingSolver(S), "cache"));
+    S = new Solver(layers.back());
+  }
+  if (UseIndependentSolver) {
+    layers.push_back(new BenchmarkLayer(createIndependentSolver(S), 
+                                        "independent"));
+    S = new Solver(layers.back());
+  }
+
+  unsigned NumFailures = 0, NumWrongAnswers = 0;
+  WallTimer total;
+  for (unsigned round = 0; round != BenchmarkRounds; ++round)
+    for (std::vector<BenchmarkQuery>::iterator it = queries.begin(),
+           ie = queries.end(); it != ie; ++it) {
+      bool answer;
+      if (!replayQuery(S, *it, answer)) {
+        ++NumFailures;
+      } else if (it->expected != -1 && answer != (it->expected == 1)) {
+        ++NumWrongAnswers;
+        if (round == 0)
+          std::cerr << it->origin << ": answered "
+                    << (answer ? "true" : "false") << ", the log recorded "
+                    << (it->expected ? "true" : "false") << "\n";
+      }
+    }
+  uint64_t totalTime = total.check();
+
+  std::cout << "{\n"
+            << "  \"files\": " << files.size() << ",\n"
+            << "  \"queries\": " << NumParsed << ",\n"
+            << "  \"unique_queries\": " << queries.size() << ",\n"
+            << "  \"rounds\": " << BenchmarkRounds << ",\n"
+            << "  \"failures\": " << NumFailures << ",\n"
+            << "  \"wrong_answers\": " << NumWrongAnswers << ",\n"
+            << "  \"total_time_us\": " << totalTime << ",\n"
+            << "  \"layers\": [\n";
+  // Outermost layer first.
+  for (unsigned i = layers.size(); i != 0; --i) {
+    BenchmarkLayer *L = layers[i - 1];
+    std::vector<uint64_t> sorted(L->samples);
+    std::sort(sorted.begin(), sorted.end());
+    uint64_t sum = 0;
+    for (unsigned j = 0, e = sorted.size(); j != e; ++j)
+      sum += sorted[j];
+    std::cout << "    { \"name\": \"" << L->name << "\""
+              << ", \"calls\": " << sorted.size()
+              << ", \"total_us\": " << sum
+              << ", \"p50_us\": " << getPercentile(sorted, 50)
+              << ", \"p90_us\": " << getPercentile(sorted, 90)
+              << ", \"p99_us\": " << getPercentile(sorted, 99)
+              << ", \"max_us\": " << (sorted.empty() ? 0 : sorted.back())
+              << " }" << (i == 1 ? "\n" : ",\n");
+  }
+  std::cout << "  ],\n"
+            << "  \"caches\": {\n";
+  printCacheStats("query_cache", "QueryCacheHits", "QueryCacheMisses", false);
+  printCacheStats("cex_cache", "QueryCexCacheHits", "QueryCexCacheMisses", 
+                  false);
+  printCacheStats("range_cache", "RangeCacheHits", "RangeCacheMisses", true);
+  std::cout << "  }\n"
+            << "}\n";
+
+  delete S;
+
+  return NumWrongAnswers == 0;
+}
+
 static bool printInputAsSMTLIBv2(const char *Filename,
                              const MemoryBuffer *MB,
                              ExprBuilder *Builder)
@@ -487,10 +878,13 @@ int main(int argc, char **argv) {
   std::string ErrorStr;
   
   OwningPtr<MemoryBuffer> MB;
-  error_code ec=MemoryBuffer::getFileOrSTDIN(InputFile.c_str(), MB);
-  if (ec) {
-    std::cerr << argv[0] << ": error: " << ec.message() << "\n";
-    return 1;
+  // The benchmark reads its own inputs, which may be a directory.
+  if (ToolAction != Benchmark) {
+    error_code ec=MemoryBuffer::getFileOrSTDIN(InputFile.c_str(), MB);
+    if (ec) {
+      std::cerr << argv[0] << ": error: " << ec.message() << "\n";
+      return 1;
+    }
   }
   
   ExprBuilder *Builder = 0;
@@ -521,6 +915,9 @@ int main(int argc, char **argv) {
     success = EvaluateInputAST(InputFile=="-" ? "<stdin>" : InputFile.c_str(),
                                MB.get(), Builder);
     break;
+  case Benchmark:
+    success = BenchmarkQueryLogs(InputFile, Builder);
+    break;
   case PrintSMTLIBv2:
     success = printInputAsSMTLIBv2(InputFile=="-"? "<stdin>" : InputFile.c_str(), MB.get(),Builder);
     break;
@@ -10,6 +10,7 @@
 #include "klee/Config/Version.h"
 #include "klee/Internal/ADT/KTest.h"
 #include "klee/Internal/ADT/TreeStream.h"
+#include "klee/Internal/Support/Driver.h"
 #include "klee/Internal/Support/ModuleUtil.h"
 #include "klee/Internal/System/Time.h"
 #include "klee/xPath.h"
@@ -56,6 +57,7 @@
 #include "llvm/Support/system_error.h"
 
 #include <dirent.h>
+#include <fcntl.h>
 #include <signal.h>
 #include <unistd.h>
 #include <sys/stat.h>
@@ -64,6 +66,7 @@
 #include <cerrno>
 #include <fstream>
 #include <iomanip>
+#include <algorithm>
 #include <iostream>
 #include <iterator>
 #include <sstream>
@@ -197,6 +200,16 @@ namespace {
     cl::list<std::string>
         SeedOutDir("seed-out-dir");
 
+    cl::opt<bool>
+        DistillSeeds("distill-seeds",
+                cl::desc("Replay the seeds concretely first, and only seed with a subset of them covering the same basic blocks (see distilled-seeds.txt)"),
+                cl::init(false));
+
+    cl::opt<unsigned>
+        DistillSeedsExtra("distill-seeds-extra",
+                cl::desc("With --distill-seeds, also seed with this many of the other seeds, those covering the most blocks first"),
+                cl::init(0));
+
     cl::opt<unsigned>
         MakeConcreteSymbolic("make-concrete-symbolic",
                 cl::desc("Rate at which to make concrete reads symbolic (0=off)"),
@@ -228,6 +241,27 @@ namespace {
 				cl::value_desc("the function to be run"),
 				cl::init("main"));
 
+	cl::opt<std::string>
+		RunFuncList("run-func-list",
+				cl::desc("Run each function named in the file (one per line, e.g. focusedFuncs.txt) with --run-func in a pool of worker processes, and collect their tests and coverage in the output directory"),
+				cl::value_desc("function list file"));
+
+	cl::opt<unsigned>
+		RunFuncJobs("run-func-jobs",
+				cl::desc("Number of --run-func-list workers to run at once (0=one per processor)"),
+				cl::init(0));
+
+	cl::opt<double>
+		RunFuncTime("run-func-time",
+				cl::desc("Seconds each --run-func-list worker may run, enforced with --watchdog (0=use --max-time)"),
+				cl::init(0));
+
+	cl::list<std::string>
+		FocusFuncs("focus-funcs",
+				cl::desc("Treat the given functions as focused when built without XQX_XPATH (which focuses every function of the program)"),
+				cl::value_desc("function name"),
+				cl::CommaSeparated);
+
 	cl::opt<bool>
 		UseLibelf("libelf", 
 				cl::desc("Link with libelf.bca"),
@@ -240,7 +274,7 @@ namespace {
 	
     cl::opt<std::string>
         SymConfigFile("sym-conf-file",
-                cl::desc("a symbolic config file to specify the symbolic data"),
+                cl::desc("a symbolic config file to specify the symbolic data: lines of off-len[:method] ranges, \"@path\" lines switch file"),
                 cl::value_desc("config file"));
 
     cl::opt<std::string>
@@ -253,6 +287,11 @@ namespace {
                 cl::desc("method of fill file, 0-2"),
                 cl::init(2));
 
+    cl::opt<bool>
+        InferSymRanges("infer-sym-ranges",
+                cl::desc("run the concolic files pinned to their contents and write the bytes reaching branches in focused functions to sym-ranges.conf"),
+                cl::init(false));
+
 	cl::opt<bool>
 		GenTestcaseOnlyPtrError("gen-ptr-err-only", 
                 cl::desc("generate testcase only when ptr.err"),
@@ -292,6 +331,9 @@ class KleeHandler : public InterpreterHandler {
         int m_argc;
         char **m_argv;
 
+        // false while replaying seeds for --distill-seeds
+        bool m_writeTestCases;
+
     public:
         KleeHandler(int argc, char **argv);
         ~KleeHandler();
@@ -300,6 +342,7 @@ class KleeHandler : public InterpreterHandler {
         unsigned getNumTestCases() { return m_testIndex; }
         unsigned getNumPathsExplored() { return m_pathsExplored; }
         void incPathsExplored() { m_pathsExplored++; }
+        void setWriteTestCases(bool write) { m_writeTestCases = write; }
 
         void setInterpreter(Interpreter *i);
 
@@ -337,7 +380,8 @@ KleeHandler::KleeHandler(int argc, char **argv)
     m_testIndex(0),
     m_pathsExplored(0),
     m_argc(argc),
-    m_argv(argv) {
+    m_argv(argv),
+    m_writeTestCases(true) {
 
         if (OutputDir=="") {
             llvm::sys::Path directory(InputFile);
@@ -519,6 +563,9 @@ void KleeHandler::processTestCase(const ExecutionState &state,
         exit(1);
     }
 
+    if (!m_writeTestCases)
+        return;
+
     // if not ptr.err, we need not generate testcase and pc, but cov.
     bool isGenAll = true;
     if( GenTestcaseOnlyPtrError && errorSuffix != "ptr.err" )
@@ -1327,6 +1374,70 @@ void StripFunc64(llvm::Module *mainModule)
 
 }
 
+static void interrupt_handle_driver() {
+	if (!interrupted) {
+		std::cerr << "KLEE: ctrl-c detected, waiting for the running workers.\n";
+		sys::SetInterruptFunction(interrupt_handle_driver);
+	} else {
+		std::cerr << "KLEE: ctrl-c detected, exiting.\n";
+		exit(1);
+	}
+	interrupted = true;
+}
+
+/// Run --run-func on each function of --run-func-list in its own worker
+/// process, collecting their test cases and coverage in the output
+/// directory (see klee::runFunctionList).
+static int driveFunctionList(int argc, char **argv) {
+	std::vector<std::string> arguments;
+	for (int i=1; i<argc; i++) {
+		if (!strcmp(argv[i],"--read-args") && i+1<argc)
+			readArgumentsFromFile(argv[++i], arguments);
+		else
+			arguments.push_back(argv[i]);
+	}
+
+	FunctionListOptions opts;
+	opts.listFile = RunFuncList;
+	opts.inputFile = InputFile;
+	opts.jobs = RunFuncJobs;
+	opts.funcTime = RunFuncTime;
+	opts.maxTime = MaxTime;
+	opts.watchdog = Watchdog;
+
+	KleeHandler *handler = new KleeHandler(argc, argv);
+	std::ostream &infoFile = handler->getInfoStream();
+	for (int i=0; i<argc; i++) {
+		infoFile << argv[i] << (i+1<argc ? " ":"\n");
+	}
+	infoFile << "PID: " << getpid() << "\n";
+
+	char buf[256];
+	time_t t[2];
+	t[0] = time(NULL);
+	strftime(buf, sizeof(buf), "Started: %Y-%m-%d %H:%M:%S\n", localtime(&t[0]));
+	infoFile << buf;
+	infoFile.flush();
+
+	sys::SetInterruptFunction(interrupt_handle_driver);
+	unsigned tests = runFunctionList(handler, argv[0], arguments, opts,
+			interrupted);
+
+	t[1] = time(NULL);
+	strftime(buf, sizeof(buf), "Finished: %Y-%m-%d %H:%M:%S\n", localtime(&t[1]));
+	infoFile << buf;
+
+	strcpy(buf, "Elapsed: ");
+	strcpy(format_tdiff(buf, t[1] - t[0]), "\n");
+	infoFile << buf;
+
+	infoFile << "KLEE: done: generated tests = " << tests << "\n";
+	std::cerr << "KLEE: done: generated tests = " << tests << "\n";
+
+	delete handler;
+	return 0;
+}
+
 int main(int argc, char **argv, char **envp) {  
 #if ENABLE_STPLOG == 1
     STPLOG_init("stplog.c");
@@ -1342,6 +1453,9 @@ int main(int argc, char **argv, char **envp) {
     parseArguments(argc, argv);
     sys::PrintStackTraceOnErrorSignal();
 
+    if (RunFuncList != "")
+        return driveFunctionList(argc, argv);
+
     if (Watchdog) {
         if (MaxTime==0) {
             klee_error("--watchdog used without --max-time");
@@ -1577,51 +1691,31 @@ LabelRunLinkedBc:
         pEnvp = envp;
     }
 
-	// addbyxqx201504  for parsing the symbolic configure file
-	// file format, off-len,off-len,....
-	int nParts=0;
-	//int nOff[1024],nLen[1024];
-	std::vector<std::string> off_vect, len_vect;
-	std::string sLine;
-
-	if( SymConfigFile != "" ) {
-		std::ifstream ifs(SymConfigFile.c_str(), std::ios::in);
-
-		//std::filebuf *pbuf = ifs.rdbuf();
-		//std::size_t fsize = pbuf->pubseekoff(0,ifs.end,ifs.in);
-		//pbuf->pubseekpos(0, ifs.in);
-		//ifs.close();
-
-		if(!ifs.good()) {
-			klee_message("open configure file error: %s", SymConfigFile.c_str());
-			return -1;
+	std::vector<Interpreter::ConcolicFile> concolicFiles;
+	if( SymConfigFile != "" &&
+			!readSymConfigFile(SymConfigFile, ConFilePath, FillFileMethod,
+				concolicFiles) )
+		return -1;
+	if( InferSymRanges ) {
+		if( concolicFiles.empty() ) {
+			if( ConFilePath == "" )
+				klee_error("--infer-sym-ranges needs --concolic-file-path or --sym-conf-file");
+			concolicFiles.push_back(Interpreter::ConcolicFile());
+			concolicFiles.back().path = ConFilePath;
 		}
-
-		while(getline(ifs, sLine))
-		{
-			size_t pos = 0;
-			std::string token, off, len;
-			while(( pos = sLine.find(",")) != std::string::npos) {
-				token = sLine.substr(0, pos);
-				//std::cout << token << "\n";
-				size_t p1=0;
-				p1 = token.find("-");
-				if( p1 == std::string::npos ){
-					klee_error("symconfigfile parsing error!");
-					return -1;
-				}
-				off = token.substr(0,p1);
-				len = token.substr(p1+1, token.length());
-				//std::cout <<"off="<< off << ",len="<<len << "\n";
-				
-				off_vect.push_back(off);
-				len_vect.push_back(len);
-				nParts++;
-
-				sLine.erase(0, pos + 1);
-			}
+		// A fill_concrete (0) range over the whole file makes it one
+		// unconstrained symbolic object. The executor seeds the object with
+		// the file contents, so the run follows the concrete path while
+		// branch conditions still show which bytes they read.
+		for (unsigned i = 0; i != concolicFiles.size(); ++i) {
+			struct stat st;
+			if( stat(concolicFiles[i].path.c_str(), &st) != 0 )
+				klee_error("unable to stat concolic file %s",
+						concolicFiles[i].path.c_str());
+			concolicFiles[i].ranges.clear();
+			concolicFiles[i].ranges.push_back(
+					Interpreter::ConcolicRange(0, st.st_size, 0));
 		}
-
 	}
 
 
@@ -1642,61 +1736,6 @@ LabelRunLinkedBc:
     }
 	klee_message("[xqx]klee main args: -----------------------");
 
-	// add addtional args for concolic file
-	if( nParts != 0)  {
-		klee_message("[xqx]klee addtional args: -----------------------");
-		int pArgcNew;
-		char **pArgvNew;
-		pArgcNew = pArgc + 4 + nParts*3;
-		pArgvNew = new char *[pArgcNew];
-		memcpy(pArgvNew, pArgv, pArgc*sizeof(char*));
-		std::string xconfile = "--xqx-confile";
-		std::string xpath = ConFilePath;
-		std::string xnum = SI2Str(nParts);
-		std::string xmethod = SI2Str(FillFileMethod);
-		std::vector<std::string> tmpArgv;
-		tmpArgv.push_back(xconfile);
-		tmpArgv.push_back(xpath);
-		tmpArgv.push_back(xnum);
-		tmpArgv.push_back(xmethod);
-
-		for (unsigned i=0; i<tmpArgv.size(); i++) {
-			std::string &arg = tmpArgv[i];
-			unsigned size = arg.size() + 1;
-			char *pArg = new char[size];
-			std::copy(arg.begin(), arg.end(), pArg);
-			pArg[size - 1] = 0;
-			pArgvNew[pArgc] = pArg;
-			klee_message("[xqx] tmpArgv[%d]: %s ", i , pArgvNew[pArgc]);
-			pArgc++;
-		}
-
-		for (unsigned j=0; j<nParts; j++) {
-			std::string xofflen = "--xqx-offlen";
-			tmpArgv.clear();
-			tmpArgv.push_back(xofflen);
-			tmpArgv.push_back(off_vect[j]);
-			tmpArgv.push_back(len_vect[j]);
-			for (unsigned i=0; i<tmpArgv.size(); i++) {
-				std::string &arg = tmpArgv[i];
-				unsigned size = arg.size() + 1;
-				char *pArg = new char[size];
-				std::copy(arg.begin(), arg.end(), pArg);
-				pArg[size - 1] = 0;
-				pArgvNew[pArgc] = pArg;
-				klee_message("[xqx] tmpArgv[%d]: %s ", i , pArgvNew[pArgc]);
-				pArgc++;
-			}
-			
-		}
-		
-		delete pArgv;
-		pArgv = pArgvNew;
-		pArgc = pArgcNew;
-		
-	}
-
-
     std::vector<bool> replayPath;
 
     if (ReplayPathFile != "") {
@@ -1705,10 +1744,12 @@ LabelRunLinkedBc:
 
     Interpreter::InterpreterOptions IOpts;
     IOpts.MakeConcreteSymbolic = MakeConcreteSymbolic;
+    IOpts.InferSymRanges = InferSymRanges;
     KleeHandler *handler = new KleeHandler(pArgc, pArgv);
     Interpreter *interpreter = 
         theInterpreter = Interpreter::create(IOpts, handler);
     handler->setInterpreter(interpreter);
+    interpreter->setConcolicFiles(concolicFiles);
 
     std::ostream &infoFile = handler->getInfoStream();
     for (int i=0; i<argc; i++) {
@@ -1728,6 +1769,10 @@ LabelRunLinkedBc:
     cg->importFocusedFuncs((fa->getFocusedFuncs()));
     cg->setFS2CGPass(fa->openOutputFile("callgraph.dot"));
     //cg->genCallGraph();
+#else
+    if (!FocusFuncs.empty())
+        interpreter->setFocusedFuncs(
+                std::set<std::string>(FocusFuncs.begin(), FocusFuncs.end()));
 #endif
     externalsAndGlobalsCheck(finalModule);
 
@@ -1791,6 +1836,7 @@ LabelRunLinkedBc:
     }
     else {
         std::vector<KTest *> seeds;
+        std::vector<std::string> seedFiles;
         for (std::vector<std::string>::iterator
                 it = SeedOutFile.begin(), ie = SeedOutFile.end();
                 it != ie; ++it) {
@@ -1800,6 +1846,7 @@ LabelRunLinkedBc:
                 exit(1);
             }
             seeds.push_back(out);
+            seedFiles.push_back(*it);
         } 
         for (std::vector<std::string>::iterator
                 it = SeedOutDir.begin(), ie = SeedOutDir.end();
@@ -1815,6 +1862,7 @@ LabelRunLinkedBc:
                     exit(1);
                 }
                 seeds.push_back(out);
+                seedFiles.push_back(*it2);
             }
             if (outFiles.empty()) {
                 std::cerr << "KLEE: seeds directory is empty: " << *it << "\n";
@@ -1822,16 +1870,27 @@ LabelRunLinkedBc:
             }
         }
 
-        if (!seeds.empty()) {
-            std::cerr << "KLEE: using " << seeds.size() << " seeds\n";
-            interpreter->useSeeds(&seeds);
-        }
         if (RunInDir != "") {
             int res = chdir(RunInDir.c_str());
             if (res < 0) {
                 klee_error("Unable to change directory to: %s", RunInDir.c_str());
             }
         }
+
+        if (DistillSeeds && !seeds.empty()) {
+            if (FuncToRun != "main") {
+                klee_warning("--distill-seeds only applies to main, keeping all seeds");
+            } else {
+                handler->setWriteTestCases(false);
+                distillSeeds(interpreter, handler, mainFn, pArgc, pArgv, pEnvp,
+                        seeds, seedFiles, DistillSeedsExtra, interrupted);
+                handler->setWriteTestCases(true);
+            }
+        }
+        if (!seeds.empty()) {
+            std::cerr << "KLEE: using " << seeds.size() << " seeds\n";
+            interpreter->useSeeds(&seeds);
+        }
 #define RUN_CUSTOM_FUNC
 #ifdef RUN_CUSTOM_FUNC
 		std::cerr << "get function : " << FuncToRun << "\n";
@@ -1874,6 +1933,9 @@ LabelRunLinkedBc:
 	//print forks info with src code info
 	interpreter->printStatsInfoWithSrcLine();
 
+	if( InferSymRanges )
+		writeInferredSymRanges(interpreter, handler, concolicFiles);
+
     delete interpreter;
 
     uint64_t queries = 
@@ -1890,11 +1952,23 @@ LabelRunLinkedBc:
         *theStatisticManager->getStatisticByName("Instructions");
     uint64_t forks = 
         *theStatisticManager->getStatisticByName("Forks");
+    uint64_t autoMerges = 
+        *theStatisticManager->getStatisticByName("AutoMerges");
+    uint64_t prunedStates = 
+        *theStatisticManager->getStatisticByName("PrunedStates");
+    uint64_t nativeCalls = 
+        *theStatisticManager->getStatisticByName("NativeCalls");
+    uint64_t speculativeForks = 
+        *theStatisticManager->getStatisticByName("SpeculativeForks");
 
 
 
     handler->getInfoStream() 
-        << "KLEE: done: explored paths = " << 1 + forks << "\n";
+        << "KLEE: done: explored paths = " << 1 + forks << "\n"
+        << "KLEE: done: auto merges = " << autoMerges << "\n"
+        << "KLEE: done: pruned states = " << prunedStates << "\n"
+        << "KLEE: done: native calls = " << nativeCalls << "\n"
+        << "KLEE: done: speculative forks = " << speculativeForks << "\n";
 
     // Write some extra information in the info file which users won't
     // necessarily care about or understand.
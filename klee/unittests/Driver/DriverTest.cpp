@@ -0,0 +1,87 @@
+//===-- DriverTest.cpp ----------------------------------------------------===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+
+#include "klee/Internal/Support/Driver.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace klee;
+
+namespace {
+
+const char *header =
+  "version: 1\n"
+  "creator: klee\n"
+  "positions: instr line\n"
+  "events: Icov Forks Iuncov UCdist IFcov IFuncov FUCdist \n"
+  "ob=test.ll\n"
+  "fn=f\n";
+
+void writeFile(const std::string &path, const std::string &contents) {
+  std::ofstream out(path.c_str());
+  out << contents;
+}
+
+std::vector<std::string> readLines(const std::string &path) {
+  std::vector<std::string> lines;
+  std::ifstream in(path.c_str());
+  std::string line;
+  while (std::getline(in, line))
+    lines.push_back(line);
+  return lines;
+}
+
+TEST(DriverTest, MergeRunIStats) {
+  std::vector<std::string> inputs;
+  inputs.push_back("DriverTest-a.istats");
+  inputs.push_back("DriverTest-b.istats");
+  std::string output = "DriverTest-merged.istats";
+
+  writeFile(inputs[0], std::string(header) +
+            "3 1 1 2 0 5 1 0 4 \n"
+            "4 2 0 0 1 7 0 1 9 \n"
+            "cfn=g\n"
+            "calls=1 7 3\n"
+            "4 2 5 1 0 0 0 0 0 \n"
+            "summary: 1 2 3 4 5 6 7\n");
+  writeFile(inputs[1], std::string(header) +
+            "3 1 1 3 0 8 1 0 6 \n"
+            "4 2 1 1 0 3 1 0 2 \n"
+            "cfn=g\n"
+            "calls=1 7 3\n"
+            "4 2 5 2 0 0 0 0 0 \n"
+            "summary: 1 2 3 4 5 6 7\n");
+
+  ASSERT_TRUE(mergeRunIStats(inputs, output));
+  std::vector<std::string> lines = readLines(output);
+  ASSERT_EQ(12U, lines.size());
+  EXPECT_EQ("fn=f", lines[5]);
+  // Icov and IFcov take the maximum, Forks is summed, the uncovered
+  // counts and distances take the minimum.
+  EXPECT_EQ("3 1 1 5 0 5 1 0 4 ", lines[6]);
+  EXPECT_EQ("4 2 1 1 0 3 1 0 2 ", lines[7]);
+  EXPECT_EQ("4 2 5 3 0 0 0 0 0 ", lines[10]);
+  // The summary adds up the self costs, leaving out the call.
+  EXPECT_EQ("summary: 2 6 0 8 2 0 6", lines[11]);
+
+  // Files of different modules are not merged.
+  writeFile(inputs[1], std::string(header) + "3 1 1 3 0 8 1 0 6 \n");
+  EXPECT_FALSE(mergeRunIStats(inputs, output));
+
+  for (unsigned i = 0; i != inputs.size(); ++i)
+    std::remove(inputs[i].c_str());
+  std::remove(output.c_str());
+}
+
+}
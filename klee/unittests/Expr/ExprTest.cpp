@@ -110,4 +110,19 @@ TEST(ExprTest, ExtractConcat) {
   EXPECT_EQ(Expr::Extract, concat2->getKid(1)->getKind());
 }
 
+TEST(ExprTest, ConstantArray) {
+  ref<ConstantExpr> values[4] = { ConstantExpr::alloc(1, Expr::Int8),
+                                  ConstantExpr::alloc(7, Expr::Int8),
+                                  ConstantExpr::alloc(3, Expr::Int8),
+                                  ConstantExpr::alloc(7, Expr::Int8) };
+  Array *array = new Array("carr", 4, values, values + 4);
+  EXPECT_TRUE(array->isConstantArray());
+  EXPECT_EQ(7U, array->getConstantValue(3));
+  EXPECT_EQ(values[2], array->getConstantExpr(2));
+
+  // Arrays built over the same contents share the bytes.
+  Array *array2 = new Array("carr2", 4, array->contents);
+  EXPECT_EQ(array->contents.get(), array2->contents.get());
+}
+
 }
@@ -161,4 +161,77 @@ TEST(SolverTest, Evaluation) {
   delete solver;
 }
 
+TEST(SolverTest, BatchedFeasibility) {
+  STPSolver *stpSolver = new STPSolver(true); 
+  Solver *solver = stpSolver;
+
+  solver = createFastCexSolver(solver);
+  solver = createCexCachingSolver(solver);
+  solver = createCachingSolver(solver);
+  solver = createIndependentSolver(solver);
+
+  Array *array = new Array("batched", 1);
+  ref<Expr> x = Expr::createTempRead(array, Expr::Int8);
+
+  ConstraintManager constraints;
+  constraints.addConstraint(UltExpr::create(x, getConstant(10, Expr::Int8)));
+
+  std::vector< ref<Expr> > exprs;
+  exprs.push_back(EqExpr::create(x, getConstant(3, Expr::Int8)));
+  exprs.push_back(EqExpr::create(x, getConstant(20, Expr::Int8)));
+  exprs.push_back(ConstantExpr::alloc(1, Expr::Bool));
+  exprs.push_back(UgtExpr::create(x, getConstant(8, Expr::Int8)));
+  exprs.push_back(UgtExpr::create(x, getConstant(9, Expr::Int8)));
+
+  // Ask twice so the second round is answered from the caches.
+  for (unsigned round = 0; round < 2; ++round) {
+    std::vector<bool> results;
+    bool success = solver->mayBeTrue(constraints, exprs, results);
+    EXPECT_EQ(true, success) << "Constraint solving failed";
+    if (!success)
+      continue;
+
+    ASSERT_EQ(exprs.size(), results.size());
+    for (unsigned i = 0; i < exprs.size(); ++i) {
+      bool expected;
+      ASSERT_TRUE(solver->mayBeTrue(Query(constraints, exprs[i]), expected));
+      EXPECT_EQ(expected, results[i]) << "Mismatch for " << exprs[i];
+    }
+    EXPECT_TRUE(results[0]);
+    EXPECT_FALSE(results[1]);
+    EXPECT_TRUE(results[2]);
+    EXPECT_TRUE(results[3]);
+    EXPECT_FALSE(results[4]);
+  }
+
+  delete solver;
+}
+
+TEST(SolverTest, Range) {
+  STPSolver *stpSolver = new STPSolver(true); 
+  Solver *solver = stpSolver;
+
+  solver = createCexCachingSolver(solver);
+  solver = createCachingSolver(solver);
+  solver = createIndependentSolver(solver);
+
+  Array *array = new Array("range", 2);
+  ref<Expr> x = Expr::createTempRead(array, Expr::Int16);
+
+  ConstraintManager constraints;
+  constraints.addConstraint(UgeExpr::create(x, getConstant(37, Expr::Int16)));
+  constraints.addConstraint(UleExpr::create(x, getConstant(1000, Expr::Int16)));
+  constraints.addConstraint(NeExpr::create(x, getConstant(1000, Expr::Int16)));
+
+  // Ask twice so the second round is answered from the range cache.
+  for (unsigned round = 0; round < 2; ++round) {
+    std::pair< ref<Expr>, ref<Expr> > range = 
+      solver->getRange(Query(constraints, x));
+    EXPECT_EQ(37U, cast<ConstantExpr>(range.first)->getZExtValue());
+    EXPECT_EQ(999U, cast<ConstantExpr>(range.second)->getZExtValue());
+  }
+
+  delete solver;
+}
+
 }